@@ -0,0 +1,804 @@
+/**
+ * @file main.cpp
+ * @author Vladislav Skvortsov
+ * @brief Micro-benchmark suite for all containers of the repository (+ std::vector/std::deque/std::list/std::priority_queue/std::unordered_map
+ *        baselines, the fixed-capacity Static* templates and the default allocator against the arena one)
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * Build:   g++ -std=c++17 -O2 -pthread Benchmark/main.cpp -o bench
+ * Run:     ./bench [--format=text|csv|json] [--filter=<substring>] [--min-size=N] [--max-size=N]
+ *                  [--max-bytes=N] [--out=<file>] [--baseline=<file.csv>] [--threshold=<percent>]
+ *
+ * Every case runs one operation N times over a container of N elements. `--filter` selects cases by name;
+ * the operations of the cases a selected one depends on still run, untimed. Operations are timed in batches of
+ * BENCH_BATCH operations; the mean is taken over all of them, and the latency percentiles are taken over the
+ * per-operation averages of the batches (a single operation is too short for the clock); cases with fewer than
+ * BENCH_MIN_BATCHES batches leave them empty (null in json, "-" in text). With `--baseline`
+ * the results are compared against an earlier `--format=csv` run, and the exit code is 1 when some case got
+ * slower by more than `--threshold` percent (10 by default), so regressions can be tracked between commits.
+ */
+
+#define DATA_STRUCTURES_NO_MAIN
+#include "../Stack/main.cpp"
+#include "../Queue/main.cpp"
+#include "../Vector/main.cpp"
+#include "../List/main.cpp"
+#include "../PriorityQueue/main.cpp"
+#include "../HashMap/main.cpp"
+#include "../Deque/main.cpp"
+
+#include <algorithm>    // for std::sort
+#include <cmath>        // for NAN && std::isnan
+#include <deque>        // for std::deque (baseline)
+#include <list>         // for std::list (baseline)
+#include <queue>        // for std::priority_queue (baseline)
+#include <memory>       // for std::unique_ptr (static containers)
+#include <string>       // for std::string
+#include <unordered_map> // for std::unordered_map (baseline)
+#include <vector>       // for std::vector (baseline && results)
+
+static const size_t BENCH_BATCH = 64;
+static const size_t BENCH_MIN_BATCHES     = 100;       // fewer batches than this give no percentiles (NaN)
+static const size_t BENCH_STATIC_CAPACITY = 16384;     // StaticStack/StaticQueue/StaticVector cases run up to this size
+static const size_t BENCH_SMALL_ELEMS     = 8;         // "small" cases: create, fill with this many elements, drain, delete
+static const size_t BENCH_SBO_CAPACITY    = 16;        // inline capacity of the small-buffer stack/vector
+static const size_t BENCH_ARENA_CHUNK     = (size_t) 1 << 20;  // chunk size of the arenas behind the "-arena" cases
+
+struct bench_options
+{
+    std::string format      = "text";
+    std::string filter      = "";
+    std::string out         = "";
+    std::string baseline    = "";
+    size_t min_size         = 100;
+    size_t max_size         = 1000000;
+    size_t max_bytes        = (size_t) 1 << 30;     // sizes whose peak footprint (bench_peak_bytes) exceeds this are skipped
+    double threshold        = 10.0;
+};
+
+struct bench_result
+{
+    std::string name;       // container/impl/op/elem_size/size
+    double ns_per_op;
+    double p50;
+    double p90;
+    double p99;
+};
+
+static struct bench_options         options;
+static std::vector<struct bench_result> results;
+
+template <size_t S>
+struct blob
+{
+    char bytes[S];
+};
+
+template <size_t S>
+bool operator==(blob<S> const &a, blob<S> const &b)
+{
+    return memcmp(a.bytes, b.bytes, S) == 0;
+}
+
+template <size_t S>
+static blob<S> make_blob(size_t i)
+{
+    blob<S> b;
+    memset(b.bytes, 0, S);
+    memcpy(b.bytes, &i, S < sizeof(i) ? S : sizeof(i));
+
+    return b;
+}
+
+static size_t blob_cmp_size = 0;
+
+static int blob_cmp(void const *elem, void const *key)
+{
+    return memcmp(elem, key, blob_cmp_size);
+}
+
+static double bench_elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Prevent the compiler from dropping results nobody reads
+static volatile size_t bench_sink;
+
+static std::string bench_name(char const *container, char const *impl, char const *op, size_t elem_size, size_t n)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s/%s/%s/%zu/%zu", container, impl, op, elem_size, n);
+
+    return buf;
+}
+
+static bool bench_enabled(std::string const &name)
+{
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+// NaN unless there are enough batches for the percentile to mean something (p99 of 2 batches is their maximum)
+static double bench_percentile(std::vector<double> const &sorted, size_t percent)
+{
+    if (sorted.size() < BENCH_MIN_BATCHES)
+    {
+        return NAN;
+    }
+
+    return sorted[sorted.size() * percent / 100];
+}
+
+// `value` printed with `format`, or `missing` if it is NaN
+static std::string bench_format(double value, char const *format, char const *missing)
+{
+    if (std::isnan(value))
+    {
+        return missing;
+    }
+
+    char buf[64];
+    snprintf(buf, sizeof(buf), format, value);
+
+    return buf;
+}
+
+/**
+ * @brief Run `op(i)` for i in [0, n) in timed batches && record the result under `name`. A case excluded by
+ *        `--filter` still runs its operations (the next case of the block works on the container it leaves), but
+ *        untimed && unrecorded.
+ */
+template <typename Op>
+static void bench_run(std::string const &name, size_t n, Op op)
+{
+    if (!bench_enabled(name))
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            op(i);
+        }
+        return;
+    }
+
+    std::vector<double> batches;
+    batches.reserve(n / BENCH_BATCH + 1);
+
+    auto total_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; )
+    {
+        size_t end = i + BENCH_BATCH < n ? i + BENCH_BATCH : n;
+        size_t ops = end - i;
+
+        auto start = std::chrono::steady_clock::now();
+        for (; i < end; ++i)
+        {
+            op(i);
+        }
+        batches.push_back(bench_elapsed_ns(start) / ops);
+    }
+    double total = bench_elapsed_ns(total_start);
+
+    std::sort(batches.begin(), batches.end());
+    struct bench_result r;
+    r.name      = name;
+    r.ns_per_op = total / n;
+    r.p50       = bench_percentile(batches, 50);
+    r.p90       = bench_percentile(batches, 90);
+    r.p99       = bench_percentile(batches, 99);
+    results.push_back(r);
+
+    if (options.format == "text")
+    {
+        fprintf(stderr, "%-48s %10.2lf ns/op  p50 %8s  p90 %8s  p99 %8s\n", name.c_str(), r.ns_per_op,
+                bench_format(r.p50, "%.2lf", "-").c_str(), bench_format(r.p90, "%.2lf", "-").c_str(),
+                bench_format(r.p99, "%.2lf", "-").c_str());
+    }
+}
+
+//-------------------------------------------------------STACK--------------------------------------------------------
+
+template <size_t S>
+static void bench_stack(size_t n)
+{
+    blob<S> elem = make_blob<S>(1);
+
+    std::string push = bench_name("stack", "stack", "push", S, n);
+    std::string pop  = bench_name("stack", "stack", "pop", S, n);
+    if (bench_enabled(push) || bench_enabled(pop))
+    {
+        struct stack *st = stack_new(S);
+        bench_run(push, n, [&](size_t) { stack_push(st, &elem); });
+        bench_run(pop,  n, [&](size_t) { stack_pop(st, &elem); });
+        st = stack_delete(st);
+    }
+
+    push = bench_name("stack", "std::vector", "push", S, n);
+    pop  = bench_name("stack", "std::vector", "pop", S, n);
+    if (bench_enabled(push) || bench_enabled(pop))
+    {
+        std::vector<blob<S>> st;
+        bench_run(push, n, [&](size_t) { st.push_back(elem); });
+        bench_run(pop,  n, [&](size_t) { elem = st.back(); st.pop_back(); });
+    }
+
+    push = bench_name("stack", "StaticStack", "push", S, n);
+    pop  = bench_name("stack", "StaticStack", "pop", S, n);
+    if (n <= BENCH_STATIC_CAPACITY && (bench_enabled(push) || bench_enabled(pop)))
+    {
+        // The object itself is too large for the thread stack with 1 KiB elements
+        std::unique_ptr<StaticStack<blob<S>, BENCH_STATIC_CAPACITY>> st(new StaticStack<blob<S>, BENCH_STATIC_CAPACITY>());
+        bench_run(push, n, [&](size_t) { st->push(elem); });
+        bench_run(pop,  n, [&](size_t) { st->pop(&elem); });
+    }
+
+    // n short-lived stacks: the small-buffer one allocates once per stack instead of twice
+    std::string small = bench_name("stack", "stack", "small", S, n);
+    if (bench_enabled(small))
+    {
+        bench_run(small, n, [&](size_t) {
+            struct stack *st = stack_new(S);
+            for (size_t i = 0; i < BENCH_SMALL_ELEMS; ++i) { stack_push(st, &elem); }
+            while (stack_pop(st, &elem) == 0) {}
+            st = stack_delete(st);
+        });
+    }
+    small = bench_name("stack", "stack-sbo", "small", S, n);
+    if (bench_enabled(small))
+    {
+        bench_run(small, n, [&](size_t) {
+            struct stack *st = stack_new_sbo(S, BENCH_SBO_CAPACITY);
+            for (size_t i = 0; i < BENCH_SMALL_ELEMS; ++i) { stack_push(st, &elem); }
+            while (stack_pop(st, &elem) == 0) {}
+            st = stack_delete(st);
+        });
+    }
+    small = bench_name("stack", "std::vector", "small", S, n);
+    if (bench_enabled(small))
+    {
+        bench_run(small, n, [&](size_t) {
+            std::vector<blob<S>> st;
+            for (size_t i = 0; i < BENCH_SMALL_ELEMS; ++i) { st.push_back(elem); }
+            while (!st.empty()) { elem = st.back(); st.pop_back(); }
+        });
+    }
+
+    // Request-scoped stacks on an arena: storage is bumped && dropped with the arena, growth happens in place
+    push = bench_name("stack", "stack-arena", "push", S, n);
+    pop  = bench_name("stack", "stack-arena", "pop", S, n);
+    small = bench_name("stack", "stack-arena", "small", S, n);
+    if (bench_enabled(push) || bench_enabled(pop) || bench_enabled(small))
+    {
+        struct ds_arena *arena = ds_arena_new(BENCH_ARENA_CHUNK);
+        struct ds_allocator on_arena = ds_arena_allocator(arena);
+
+        struct stack *st = stack_new_alloc(S, &on_arena);
+        bench_run(push, n, [&](size_t) { stack_push(st, &elem); });
+        bench_run(pop,  n, [&](size_t) { stack_pop(st, &elem); });
+        st = stack_delete(st);
+        ds_arena_reset(arena);
+
+        bench_run(small, n, [&](size_t) {
+            struct stack *st = stack_new_alloc(S, &on_arena);
+            for (size_t i = 0; i < BENCH_SMALL_ELEMS; ++i) { stack_push(st, &elem); }
+            while (stack_pop(st, &elem) == 0) {}
+            st = stack_delete(st);
+            ds_arena_reset(arena);
+        });
+        arena = ds_arena_delete(arena);
+    }
+}
+
+//-------------------------------------------------------QUEUE--------------------------------------------------------
+
+template <size_t S>
+static void bench_queue(size_t n)
+{
+    blob<S> elem = make_blob<S>(1);
+
+    std::string push = bench_name("queue", "queue", "push", S, n);
+    std::string pop  = bench_name("queue", "queue", "pop", S, n);
+    if (bench_enabled(push) || bench_enabled(pop))
+    {
+        struct queue *q = queue_new(S);
+        bench_run(push, n, [&](size_t) { queue_push(q, &elem); });
+        bench_run(pop,  n, [&](size_t) { queue_pop(q, &elem); });
+        q = queue_delete(q);
+    }
+
+    push = bench_name("queue", "std::deque", "push", S, n);
+    pop  = bench_name("queue", "std::deque", "pop", S, n);
+    if (bench_enabled(push) || bench_enabled(pop))
+    {
+        std::deque<blob<S>> q;
+        bench_run(push, n, [&](size_t) { q.push_back(elem); });
+        bench_run(pop,  n, [&](size_t) { elem = q.front(); q.pop_front(); });
+    }
+
+    push = bench_name("queue", "StaticQueue", "push", S, n);
+    pop  = bench_name("queue", "StaticQueue", "pop", S, n);
+    if (n <= BENCH_STATIC_CAPACITY && (bench_enabled(push) || bench_enabled(pop)))
+    {
+        std::unique_ptr<StaticQueue<blob<S>, BENCH_STATIC_CAPACITY>> q(new StaticQueue<blob<S>, BENCH_STATIC_CAPACITY>());
+        bench_run(push, n, [&](size_t) { q->push(elem); });
+        bench_run(pop,  n, [&](size_t) { q->pop(&elem); });
+    }
+
+    push = bench_name("queue", "queue-arena", "push", S, n);
+    pop  = bench_name("queue", "queue-arena", "pop", S, n);
+    if (bench_enabled(push) || bench_enabled(pop))
+    {
+        struct ds_arena *arena = ds_arena_new(BENCH_ARENA_CHUNK);
+        struct ds_allocator on_arena = ds_arena_allocator(arena);
+
+        struct queue *q = queue_new_alloc(S, &on_arena);
+        bench_run(push, n, [&](size_t) { queue_push(q, &elem); });
+        bench_run(pop,  n, [&](size_t) { queue_pop(q, &elem); });
+        q = queue_delete(q);
+        arena = ds_arena_delete(arena);
+    }
+}
+
+//-------------------------------------------------------VECTOR-------------------------------------------------------
+
+template <size_t S>
+static void bench_vector(size_t n)
+{
+    blob<S> elem = make_blob<S>(1);
+    blob<S> missing = make_blob<S>(n + 1);
+    size_t finds = n < 64 ? n : 64;     // every find is a full scan, so only a few of them are run
+
+    char const *ops[] = {"push", "get", "set", "find", "insert", "erase", "pop", "small"};
+    bool enabled = false;
+    for (char const *op : ops)
+    {
+        enabled = enabled || bench_enabled(bench_name("vector", "vector", op, S, n)) || bench_enabled(bench_name("vector", "std::vector", op, S, n))
+                          || bench_enabled(bench_name("vector", "StaticVector", op, S, n)) || bench_enabled(bench_name("vector", "vector-sbo", op, S, n))
+                          || bench_enabled(bench_name("vector", "vector-arena", op, S, n));
+    }
+    if (!enabled)
+    {
+        return;
+    }
+
+    // insert/erase at the front shift the whole vector, so they run on a small container
+    size_t small = n < 1000 ? n : 1000;
+
+    struct vector *v = vector_new(0, S);
+    bench_run(bench_name("vector", "vector", "push", S, n), n, [&](size_t i) { elem = make_blob<S>(i); vector_push(v, &elem); });
+    bench_run(bench_name("vector", "vector", "get", S, n),  n, [&](size_t i) { vector_get(v, i, &elem); });
+    bench_run(bench_name("vector", "vector", "set", S, n),  n, [&](size_t i) { vector_set(v, i, &elem); });
+    bench_run(bench_name("vector", "vector", "find", S, n), finds, [&](size_t) {
+        size_t found = v->size;
+        if (S == sizeof(int32_t))
+        {
+            found = vector_find(v, VECTOR_INT32, &missing);
+        }
+        else
+        {
+            for (size_t i = 0; i < v->size; ++i)
+            {
+                if (memcmp(vector_at(v, i), &missing, S) == 0)
+                {
+                    found = i;
+                    break;
+                }
+            }
+        }
+        bench_sink = found;
+    });
+    bench_run(bench_name("vector", "vector", "pop", S, n), n, [&](size_t) { vector_pop(v, &elem); });
+    bench_run(bench_name("vector", "vector", "insert", S, small), small, [&](size_t) { vector_insert_range(v, 0, &elem, 1); });
+    bench_run(bench_name("vector", "vector", "erase", S, small), small, [&](size_t) { vector_erase_range(v, 0, 1); });
+    v = vector_delete(v);
+
+    std::vector<blob<S>> sv;
+    bench_run(bench_name("vector", "std::vector", "push", S, n), n, [&](size_t i) { sv.push_back(make_blob<S>(i)); });
+    bench_run(bench_name("vector", "std::vector", "get", S, n),  n, [&](size_t i) { elem = sv[i]; });
+    bench_run(bench_name("vector", "std::vector", "set", S, n),  n, [&](size_t i) { sv[i] = elem; });
+    bench_run(bench_name("vector", "std::vector", "find", S, n), finds, [&](size_t) {
+        bench_sink = std::find(sv.begin(), sv.end(), missing) - sv.begin();
+    });
+    bench_run(bench_name("vector", "std::vector", "pop", S, n), n, [&](size_t) { elem = sv.back(); sv.pop_back(); });
+    bench_run(bench_name("vector", "std::vector", "insert", S, small), small, [&](size_t) { sv.insert(sv.begin(), elem); });
+    bench_run(bench_name("vector", "std::vector", "erase", S, small), small, [&](size_t) { sv.erase(sv.begin()); });
+
+    if (n <= BENCH_STATIC_CAPACITY)
+    {
+        std::unique_ptr<StaticVector<blob<S>, BENCH_STATIC_CAPACITY>> stv(new StaticVector<blob<S>, BENCH_STATIC_CAPACITY>());
+        bench_run(bench_name("vector", "StaticVector", "push", S, n), n, [&](size_t i) { stv->push_back(make_blob<S>(i)); });
+        bench_run(bench_name("vector", "StaticVector", "get", S, n),  n, [&](size_t i) { elem = (*stv)[i]; });
+        bench_run(bench_name("vector", "StaticVector", "set", S, n),  n, [&](size_t i) { (*stv)[i] = elem; });
+        bench_run(bench_name("vector", "StaticVector", "pop", S, n),  n, [&](size_t) { stv->pop_back(&elem); });
+    }
+
+    // n short-lived vectors: the small-buffer one allocates once per vector instead of twice (or more while growing)
+    bench_run(bench_name("vector", "vector", "small", S, n), n, [&](size_t) {
+        struct vector *sv = vector_new(0, S);
+        for (size_t i = 0; i < BENCH_SMALL_ELEMS; ++i) { vector_push(sv, &elem); }
+        while (vector_pop(sv, &elem) == 0) {}
+        sv = vector_delete(sv);
+    });
+    bench_run(bench_name("vector", "vector-sbo", "small", S, n), n, [&](size_t) {
+        struct vector *sv = vector_new_sbo(0, S, BENCH_SBO_CAPACITY);
+        for (size_t i = 0; i < BENCH_SMALL_ELEMS; ++i) { vector_push(sv, &elem); }
+        while (vector_pop(sv, &elem) == 0) {}
+        sv = vector_delete(sv);
+    });
+    bench_run(bench_name("vector", "std::vector", "small", S, n), n, [&](size_t) {
+        std::vector<blob<S>> sv;
+        for (size_t i = 0; i < BENCH_SMALL_ELEMS; ++i) { sv.push_back(elem); }
+        while (!sv.empty()) { elem = sv.back(); sv.pop_back(); }
+    });
+
+    // The same vector on an arena: the elements are the most recent arena block, so growing never copies them
+    // until the chunk is full
+    struct ds_arena *arena = ds_arena_new(BENCH_ARENA_CHUNK);
+    struct ds_allocator on_arena = ds_arena_allocator(arena);
+
+    v = vector_new_alloc(0, S, &on_arena);
+    bench_run(bench_name("vector", "vector-arena", "push", S, n), n, [&](size_t i) { elem = make_blob<S>(i); vector_push(v, &elem); });
+    bench_run(bench_name("vector", "vector-arena", "get", S, n),  n, [&](size_t i) { vector_get(v, i, &elem); });
+    bench_run(bench_name("vector", "vector-arena", "pop", S, n),  n, [&](size_t) { vector_pop(v, &elem); });
+    v = vector_delete(v);
+    ds_arena_reset(arena);
+
+    bench_run(bench_name("vector", "vector-arena", "small", S, n), n, [&](size_t) {
+        struct vector *sv = vector_new_alloc(0, S, &on_arena);
+        for (size_t i = 0; i < BENCH_SMALL_ELEMS; ++i) { vector_push(sv, &elem); }
+        while (vector_pop(sv, &elem) == 0) {}
+        sv = vector_delete(sv);
+        ds_arena_reset(arena);
+    });
+    arena = ds_arena_delete(arena);
+}
+
+//--------------------------------------------------------LIST--------------------------------------------------------
+
+template <size_t S>
+static void bench_list(size_t n)
+{
+    blob<S> elem = make_blob<S>(1);
+    blob<S> missing = make_blob<S>(n + 1);
+    size_t finds = n < 64 ? n : 64;
+
+    char const *ops[] = {"push", "find", "insert", "erase"};
+    bool enabled = false;
+    for (char const *op : ops)
+    {
+        enabled = enabled || bench_enabled(bench_name("list", "glist", op, S, n)) || bench_enabled(bench_name("list", "std::list", op, S, n))
+                          || bench_enabled(bench_name("list", "glist-arena", op, S, n));
+    }
+    if (!enabled)
+    {
+        return;
+    }
+
+    // push appends, insert prepends, erase removes the current head (found with the comparator)
+    struct glist *gl = glist_new(S);
+    blob_cmp_size = S;
+    bench_run(bench_name("list", "glist", "push", S, n), n, [&](size_t i) { elem = make_blob<S>(i); glist_push_back(gl, &elem); });
+    bench_run(bench_name("list", "glist", "find", S, n), finds, [&](size_t) { bench_sink = (size_t) glist_find(gl, &missing, blob_cmp); });
+    bench_run(bench_name("list", "glist", "insert", S, n), n, [&](size_t) { glist_push_front(gl, &elem); });
+    bench_run(bench_name("list", "glist", "erase", S, n), n, [&](size_t) { glist_erase(gl, glist_data(gl, gl->head), blob_cmp); });
+    gl = glist_delete(gl);
+
+    // Pool chunks from an arena: only the chunk allocations change, node recycling stays in the pool
+    struct ds_arena *arena = ds_arena_new(BENCH_ARENA_CHUNK);
+    struct ds_allocator on_arena = ds_arena_allocator(arena);
+
+    gl = glist_new_alloc(S, &on_arena);
+    bench_run(bench_name("list", "glist-arena", "push", S, n), n, [&](size_t i) { elem = make_blob<S>(i); glist_push_back(gl, &elem); });
+    bench_run(bench_name("list", "glist-arena", "find", S, n), finds, [&](size_t) { bench_sink = (size_t) glist_find(gl, &missing, blob_cmp); });
+    bench_run(bench_name("list", "glist-arena", "insert", S, n), n, [&](size_t) { glist_push_front(gl, &elem); });
+    bench_run(bench_name("list", "glist-arena", "erase", S, n), n, [&](size_t) { glist_erase(gl, glist_data(gl, gl->head), blob_cmp); });
+    gl = glist_delete(gl);
+    arena = ds_arena_delete(arena);
+
+    std::list<blob<S>> sl;
+    bench_run(bench_name("list", "std::list", "push", S, n), n, [&](size_t i) { sl.push_back(make_blob<S>(i)); });
+    bench_run(bench_name("list", "std::list", "find", S, n), finds, [&](size_t) { bench_sink = std::find(sl.begin(), sl.end(), missing) == sl.end(); });
+    bench_run(bench_name("list", "std::list", "insert", S, n), n, [&](size_t) { sl.push_front(elem); });
+    bench_run(bench_name("list", "std::list", "erase", S, n), n, [&](size_t) { sl.erase(std::find(sl.begin(), sl.end(), sl.front())); });
+}
+
+//---------------------------------------------------PRIORITY QUEUE---------------------------------------------------
+
+template <size_t S>
+struct blob_greater
+{
+    bool operator()(blob<S> const &a, blob<S> const &b) const
+    {
+        return memcmp(a.bytes, b.bytes, S) > 0;
+    }
+};
+
+template <size_t S>
+static void bench_pqueue(size_t n)
+{
+    // Keys in scrambled order, so that pushes sift up a few levels && pops go all the way down
+    blob<S> elem = make_blob<S>(1);
+    blob_cmp_size = S;
+
+    const size_t arities[] = {2, 4, 8};
+    for (size_t arity : arities)
+    {
+        char impl[16];
+        snprintf(impl, sizeof(impl), "pqueue-%zu", arity);
+        std::string push = bench_name("pqueue", impl, "push", S, n);
+        std::string pop  = bench_name("pqueue", impl, "pop", S, n);
+        if (bench_enabled(push) || bench_enabled(pop))
+        {
+            struct pqueue *pq = pqueue_new(S, arity, blob_cmp);
+            bench_run(push, n, [&](size_t i) { elem = make_blob<S>(i * 2654435761u % n); pqueue_push(pq, &elem); });
+            bench_run(pop,  n, [&](size_t) { pqueue_pop(pq, &elem); });
+            pq = pqueue_delete(pq);
+        }
+    }
+
+    std::string push = bench_name("pqueue", "std::priority_queue", "push", S, n);
+    std::string pop  = bench_name("pqueue", "std::priority_queue", "pop", S, n);
+    if (bench_enabled(push) || bench_enabled(pop))
+    {
+        std::priority_queue<blob<S>, std::vector<blob<S>>, blob_greater<S>> pq;
+        bench_run(push, n, [&](size_t i) { pq.push(make_blob<S>(i * 2654435761u % n)); });
+        bench_run(pop,  n, [&](size_t) { elem = pq.top(); pq.pop(); });
+    }
+}
+
+//------------------------------------------------------HASH MAP------------------------------------------------------
+
+template <size_t S>
+struct blob_hash
+{
+    size_t operator()(blob<S> const &b) const
+    {
+        return (size_t) hashmap_hash_bytes(b.bytes, S);
+    }
+};
+
+template <size_t S>
+static void bench_hashmap(size_t n)
+{
+    // Keys are the blobs of 0..n-1 (distinct for every element size), looked up in a scrambled order
+    std::string insert = bench_name("hashmap", "hashmap", "insert", S, n);
+    std::string find   = bench_name("hashmap", "hashmap", "find", S, n);
+    std::string erase  = bench_name("hashmap", "hashmap", "erase", S, n);
+    if (bench_enabled(insert) || bench_enabled(find) || bench_enabled(erase))
+    {
+        struct hashmap *map = hashmap_new(S, sizeof(size_t), NULL, NULL);
+        bench_run(insert, n, [&](size_t i) { blob<S> key = make_blob<S>(i); hashmap_insert(map, &key, &i); });
+        bench_run(find,   n, [&](size_t i) { blob<S> key = make_blob<S>(i * 2654435761u % n); bench_sink = *(size_t *) hashmap_find(map, &key); });
+        bench_run(erase,  n, [&](size_t i) { blob<S> key = make_blob<S>(i * 2654435761u % n); hashmap_erase(map, &key); });
+        map = hashmap_delete(map);
+    }
+
+    insert = bench_name("hashmap", "std::unordered_map", "insert", S, n);
+    find   = bench_name("hashmap", "std::unordered_map", "find", S, n);
+    erase  = bench_name("hashmap", "std::unordered_map", "erase", S, n);
+    if (bench_enabled(insert) || bench_enabled(find) || bench_enabled(erase))
+    {
+        std::unordered_map<blob<S>, size_t, blob_hash<S>> map;
+        bench_run(insert, n, [&](size_t i) { map[make_blob<S>(i)] = i; });
+        bench_run(find,   n, [&](size_t i) { bench_sink = map.find(make_blob<S>(i * 2654435761u % n))->second; });
+        bench_run(erase,  n, [&](size_t i) { map.erase(make_blob<S>(i * 2654435761u % n)); });
+    }
+}
+
+//-------------------------------------------------------DEQUE--------------------------------------------------------
+
+template <size_t S>
+static void bench_deque(size_t n)
+{
+    // Pushes alternate between the ends, gets read scrambled indices, pops drain one end each
+    blob<S> elem = make_blob<S>(1);
+
+    char const *ops[] = {"push", "get", "pop"};
+    bool enabled = false;
+    for (char const *op : ops)
+    {
+        enabled = enabled || bench_enabled(bench_name("deque", "deque", op, S, n)) || bench_enabled(bench_name("deque", "std::deque", op, S, n));
+    }
+    if (!enabled)
+    {
+        return;
+    }
+
+    struct deque *d = deque_new(S);
+    bench_run(bench_name("deque", "deque", "push", S, n), n, [&](size_t i) { (i & 1) ? deque_push_front(d, &elem) : deque_push_back(d, &elem); });
+    bench_run(bench_name("deque", "deque", "get", S, n), n, [&](size_t i) { deque_get(d, i * 2654435761u % n, &elem); });
+    bench_run(bench_name("deque", "deque", "pop", S, n), n, [&](size_t i) { (i & 1) ? deque_pop_front(d, &elem) : deque_pop_back(d, &elem); });
+    d = deque_delete(d);
+
+    std::deque<blob<S>> sd;
+    bench_run(bench_name("deque", "std::deque", "push", S, n), n, [&](size_t i) { (i & 1) ? sd.push_front(elem) : sd.push_back(elem); });
+    bench_run(bench_name("deque", "std::deque", "get", S, n), n, [&](size_t i) { elem = sd[i * 2654435761u % n]; });
+    bench_run(bench_name("deque", "std::deque", "pop", S, n), n, [&](size_t i) {
+        if (i & 1)
+        {
+            elem = sd.front();
+            sd.pop_front();
+        }
+        else
+        {
+            elem = sd.back();
+            sd.pop_back();
+        }
+    });
+}
+
+//-------------------------------------------------------DRIVER-------------------------------------------------------
+
+/**
+ * @brief Most memory bench_all<S>(n) holds at once (checked against `--max-bytes`). Containers of a block are deleted
+ *        before the next one is built, so a block costs its largest container:
+ *          - the lists grow to 2n nodes (n push_back, then n push_front), each with two links && a malloc header,
+ *          - the hash map keeps up to 2n / 0.875 slots of key, value && control byte, 1.5 times that while it
+ *            rehashes; std::unordered_map takes a malloc'd node (key, value, link, hash) && a bucket per element,
+ *          - the vector block keeps the drained std::vector (n elements) while the arena vector leaves every
+ *            outgrown block in the arena (2n more); the other arrays hold old && new storage while growing.
+ *        malloc keeps much of what a block freed for the next one, so the two largest blocks are added up.
+ */
+static size_t bench_peak_bytes(size_t n, size_t elem_size)
+{
+    size_t list    = 2 * n * (elem_size + 2 * sizeof(void *) + 16);
+    size_t hashmap = std::max((size_t) (3.5 * (double) n) * (elem_size + sizeof(size_t) + 1),
+                              n * (elem_size + 7 * sizeof(size_t)));
+    size_t vector  = 3 * n * elem_size;
+
+    size_t blocks[] = {list, hashmap, vector};
+    std::sort(blocks, blocks + 3);
+
+    return blocks[1] + blocks[2];
+}
+
+template <size_t S>
+static void bench_all(size_t n)
+{
+    // Skip cases that would not fit into the memory budget
+    if (bench_peak_bytes(n, S) > options.max_bytes)
+    {
+        return;
+    }
+
+    bench_stack<S>(n);
+    bench_queue<S>(n);
+    bench_vector<S>(n);
+    bench_list<S>(n);
+    bench_pqueue<S>(n);
+    bench_hashmap<S>(n);
+    bench_deque<S>(n);
+}
+
+static void print_results(FILE *out)
+{
+    if (options.format == "csv")
+    {
+        fprintf(out, "name,ns_per_op,p50,p90,p99\n");
+        for (struct bench_result const &r : results)
+        {
+            fprintf(out, "%s,%.3lf,%s,%s,%s\n", r.name.c_str(), r.ns_per_op, bench_format(r.p50, "%.3lf", "").c_str(),
+                    bench_format(r.p90, "%.3lf", "").c_str(), bench_format(r.p99, "%.3lf", "").c_str());
+        }
+    }
+    else if (options.format == "json")
+    {
+        fprintf(out, "{\n  \"unit\": \"ns\",\n  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            struct bench_result const &r = results[i];
+            fprintf(out, "    {\"name\": \"%s\", \"ns_per_op\": %.3lf, \"p50\": %s, \"p90\": %s, \"p99\": %s}%s\n",
+                    r.name.c_str(), r.ns_per_op, bench_format(r.p50, "%.3lf", "null").c_str(), bench_format(r.p90, "%.3lf", "null").c_str(),
+                    bench_format(r.p99, "%.3lf", "null").c_str(), i + 1 < results.size() ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+    }
+}
+
+static int compare_with_baseline()
+{
+    FILE *in = fopen(options.baseline.c_str(), "r");
+    if (in == NULL)
+    {
+        fprintf(stderr, "can't open baseline %s\n", options.baseline.c_str());
+        return 1;
+    }
+
+    // Cases missing from either run are ignored
+    int regressions = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), in))
+    {
+        char *comma = strchr(line, ',');
+        if (comma == NULL)
+        {
+            continue;
+        }
+        *comma = '\0';
+        double old_ns = atof(comma + 1);
+
+        for (struct bench_result const &r : results)
+        {
+            if (r.name == line && old_ns > 0)
+            {
+                double change = 100.0 * (r.ns_per_op - old_ns) / old_ns;
+                if (change > options.threshold)
+                {
+                    fprintf(stderr, "REGRESSION %-48s %10.2lf -> %10.2lf ns/op (%+.1lf%%)\n", line, old_ns, r.ns_per_op, change);
+                    ++regressions;
+                }
+            }
+        }
+    }
+    fclose(in);
+
+    fprintf(stderr, "%d regression(s) above %.1lf%%\n", regressions, options.threshold);
+
+    return regressions != 0;
+}
+
+static bool parse_option(char const *arg, char const *key, std::string *value)
+{
+    size_t len = strlen(key);
+    if (strncmp(arg, key, len) != 0 || arg[len] != '=')
+    {
+        return false;
+    }
+
+    *value = arg + len + 1;
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // Parse options
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string value;
+        if      (parse_option(argv[i], "--format", &options.format))     {}
+        else if (parse_option(argv[i], "--filter", &options.filter))     {}
+        else if (parse_option(argv[i], "--out", &options.out))           {}
+        else if (parse_option(argv[i], "--baseline", &options.baseline)) {}
+        else if (parse_option(argv[i], "--min-size", &value))            { options.min_size  = strtoull(value.c_str(), NULL, 10); }
+        else if (parse_option(argv[i], "--max-size", &value))            { options.max_size  = strtoull(value.c_str(), NULL, 10); }
+        else if (parse_option(argv[i], "--max-bytes", &value))           { options.max_bytes = strtoull(value.c_str(), NULL, 10); }
+        else if (parse_option(argv[i], "--threshold", &value))           { options.threshold = atof(value.c_str()); }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    // Element sizes 4 B .. 1 KiB, container sizes by powers of ten (1e2 .. 1e8 with --max-size=100000000)
+    for (size_t n = options.min_size; n <= options.max_size; n *= 10)
+    {
+        bench_all<4>(n);
+        bench_all<16>(n);
+        bench_all<64>(n);
+        bench_all<256>(n);
+        bench_all<1024>(n);
+    }
+
+    // Machine readable output
+    FILE *out = options.out.empty() ? stdout : fopen(options.out.c_str(), "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "can't open %s\n", options.out.c_str());
+        return 2;
+    }
+    print_results(out);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+#ifdef DS_STATS
+    // Built with -DDS_STATS: counters of every container instance the benchmarks created
+    ds_stats_dump_global(stderr, 0);
+#endif
+
+    return options.baseline.empty() ? 0 : compare_with_baseline();
+}
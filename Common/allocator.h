@@ -0,0 +1,246 @@
+/**
+ * @file allocator.h
+ * @author Vladislav Skvortsov
+ * @brief Pluggable allocator interface of the containers (+ malloc-based default && arena implementations)
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * A `struct ds_allocator` is a small vtable (allocate/reallocate/deallocate) plus a context pointer handed back to
+ * every call; containers copy it by value when they are created (stack_new_alloc, queue_new_alloc,
+ * vector_new_alloc, list_pool_new_alloc, glist_new_alloc, ulist_new_alloc) and get their element storage (and
+ * node chunks) from it. The container structs themselves still come from malloc/calloc. Sizes are passed back on
+ * reallocate/deallocate, so allocators need no headers.
+ * The context (an arena, a jemalloc arena index, a memory policy...) must outlive every container using it.
+ */
+
+#ifndef DATA_STRUCTURES_ALLOCATOR_H
+#define DATA_STRUCTURES_ALLOCATOR_H
+
+#include <stddef.h> // for size_t && max_align_t
+#include <stdlib.h> // for malloc && realloc && free
+#include <string.h> // for memcpy && memset
+
+struct ds_allocator
+{
+    void *(*allocate)(void *ctx, size_t bytes);
+    void *(*reallocate)(void *ctx, void *ptr, size_t old_bytes, size_t new_bytes);     // NULL on failure, `ptr` stays valid
+    void  (*deallocate)(void *ctx, void *ptr, size_t bytes);
+    void *ctx;
+};
+
+//--------------------------------------------------------DEFAULT-----------------------------------------------------
+
+static inline void *ds_malloc_allocate(void *ctx, size_t bytes)
+{
+    (void) ctx;
+
+    return malloc(bytes);
+}
+
+static inline void *ds_malloc_reallocate(void *ctx, void *ptr, size_t old_bytes, size_t new_bytes)
+{
+    (void) ctx;
+    (void) old_bytes;
+
+    return realloc(ptr, new_bytes);
+}
+
+static inline void ds_malloc_deallocate(void *ctx, void *ptr, size_t bytes)
+{
+    (void) ctx;
+    (void) bytes;
+
+    free(ptr);
+}
+
+static const struct ds_allocator DS_DEFAULT_ALLOCATOR = {ds_malloc_allocate, ds_malloc_reallocate, ds_malloc_deallocate, NULL};
+
+static inline void *ds_allocate(struct ds_allocator const *a, size_t bytes)
+{
+    return a->allocate(a->ctx, bytes);
+}
+
+static inline void *ds_allocate_zeroed(struct ds_allocator const *a, size_t bytes)
+{
+    void *ptr = a->allocate(a->ctx, bytes);
+    if (ptr != NULL)
+    {
+        memset(ptr, 0, bytes);
+    }
+
+    return ptr;
+}
+
+static inline void *ds_reallocate(struct ds_allocator const *a, void *ptr, size_t old_bytes, size_t new_bytes)
+{
+    return a->reallocate(a->ctx, ptr, old_bytes, new_bytes);
+}
+
+static inline void ds_deallocate(struct ds_allocator const *a, void *ptr, size_t bytes)
+{
+    a->deallocate(a->ctx, ptr, bytes);
+}
+
+// Move the first `used` bytes of a block of `bytes` bytes to a block of the same size from another allocator
+static inline void *ds_allocator_move(struct ds_allocator const *from, struct ds_allocator const *to, void *ptr, size_t bytes, size_t used)
+{
+    void *moved = to->allocate(to->ctx, bytes);
+    if (moved == NULL)
+    {
+        return NULL;
+    }
+    if (used != 0)
+    {
+        memcpy(moved, ptr, used);
+    }
+    from->deallocate(from->ctx, ptr, bytes);
+
+    return moved;
+}
+
+//---------------------------------------------------------ARENA------------------------------------------------------
+
+/**
+ * @brief Bump allocator for request-scoped data: allocation is a pointer increment inside the current chunk,
+ *        deallocate does nothing (except for the most recent block, which is rolled back), reallocate of the
+ *        most recent block grows it in place when the chunk has room. ds_arena_reset drops everything at once.
+ */
+struct ds_arena
+{
+    char *chunks;           // newest chunk; every chunk starts with a pointer to the previous one && its size
+    char *bump;             // first free byte of the newest chunk
+    char *end;              // end of the newest chunk
+    char *last;             // most recent block (may be resized in place)
+
+    size_t chunk_size;      // default chunk size, bigger blocks get a chunk of their own
+    size_t bytes_used;      // bytes handed out since the last reset (statistics)
+};
+
+static const size_t DS_ARENA_ALIGN          = alignof(max_align_t);
+static const size_t DS_ARENA_CHUNK_HEADER   = (sizeof(char *) + sizeof(size_t) + DS_ARENA_ALIGN - 1) & ~(DS_ARENA_ALIGN - 1);
+
+static inline size_t ds_arena_round(size_t bytes)
+{
+    return (bytes + DS_ARENA_ALIGN - 1) & ~(DS_ARENA_ALIGN - 1);
+}
+
+static inline struct ds_arena *ds_arena_new(size_t chunk_size)
+{
+    struct ds_arena *arena = (struct ds_arena *) calloc(1, sizeof(struct ds_arena));
+    if (arena != NULL)
+    {
+        arena->chunk_size = chunk_size;
+    }
+
+    return arena;
+}
+
+// Release every chunk but the newest one (kept for reuse) && start over
+static inline void ds_arena_reset(struct ds_arena *arena)
+{
+    if (arena->chunks == NULL)
+    {
+        return;
+    }
+
+    char *prev = *(char **) arena->chunks;
+    while (prev != NULL)
+    {
+        char *next = *(char **) prev;
+        free(prev);
+        prev = next;
+    }
+    *(char **) arena->chunks = NULL;
+
+    arena->bump         = arena->chunks + DS_ARENA_CHUNK_HEADER;
+    arena->end          = arena->chunks + *(size_t *) (arena->chunks + sizeof(char *));
+    arena->last         = NULL;
+    arena->bytes_used   = 0;
+}
+
+static inline struct ds_arena *ds_arena_delete(struct ds_arena *arena)
+{
+    while (arena->chunks != NULL)
+    {
+        char *prev = *(char **) arena->chunks;
+        free(arena->chunks);
+        arena->chunks = prev;
+    }
+    free(arena);
+
+    return NULL;
+}
+
+static inline void *ds_arena_allocate(void *ctx, size_t bytes)
+{
+    struct ds_arena *arena = (struct ds_arena *) ctx;
+    bytes = ds_arena_round(bytes ? bytes : 1);
+
+    // Start a new chunk when the block does not fit (the rest of the old one is wasted)
+    if ((size_t) (arena->end - arena->bump) < bytes)
+    {
+        size_t size = DS_ARENA_CHUNK_HEADER + (bytes > arena->chunk_size ? bytes : arena->chunk_size);
+        char *chunk = (char *) malloc(size);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+
+        *(char **) chunk = arena->chunks;
+        *(size_t *) (chunk + sizeof(char *)) = size;
+        arena->chunks   = chunk;
+        arena->bump     = chunk + DS_ARENA_CHUNK_HEADER;
+        arena->end      = chunk + size;
+    }
+
+    arena->last         = arena->bump;
+    arena->bump        += bytes;
+    arena->bytes_used  += bytes;
+
+    return arena->last;
+}
+
+static inline void *ds_arena_reallocate(void *ctx, void *ptr, size_t old_bytes, size_t new_bytes)
+{
+    struct ds_arena *arena = (struct ds_arena *) ctx;
+
+    // The most recent block just moves the bump pointer
+    if (ptr != NULL && ptr == arena->last && (size_t) (arena->end - arena->last) >= ds_arena_round(new_bytes))
+    {
+        arena->bytes_used  += ds_arena_round(new_bytes) - (arena->bump - arena->last);
+        arena->bump         = arena->last + ds_arena_round(new_bytes);
+        return ptr;
+    }
+
+    void *moved = ds_arena_allocate(ctx, new_bytes);
+    if (moved != NULL && ptr != NULL)
+    {
+        memcpy(moved, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+    }
+
+    return moved;
+}
+
+static inline void ds_arena_deallocate(void *ctx, void *ptr, size_t bytes)
+{
+    struct ds_arena *arena = (struct ds_arena *) ctx;
+    (void) bytes;
+
+    // Only the most recent block can be given back
+    if (ptr != NULL && ptr == arena->last)
+    {
+        arena->bytes_used  -= arena->bump - arena->last;
+        arena->bump         = arena->last;
+        arena->last         = NULL;
+    }
+}
+
+static inline struct ds_allocator ds_arena_allocator(struct ds_arena *arena)
+{
+    struct ds_allocator a = {ds_arena_allocate, ds_arena_reallocate, ds_arena_deallocate, arena};
+
+    return a;
+}
+
+#endif // DATA_STRUCTURES_ALLOCATOR_H
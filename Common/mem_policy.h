@@ -0,0 +1,290 @@
+/**
+ * @file mem_policy.h
+ * @author Vladislav Skvortsov
+ * @brief Allocation policy for large container storage: blocks above a threshold come from mmap (transparent huge
+ *        pages or MAP_HUGETLB) and may be bound to / interleaved over NUMA nodes (+ node query for tests)
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * Stack, queue and vector get their element storage from a `struct ds_allocator` (see allocator.h);
+ * ds_mem_allocator wraps a policy into one (*_set_mem_policy does that for an existing container, over a copy of
+ * the policy kept in the container). Whether a block is mapped depends only on its size, so the container passes
+ * the size it allocated with to realloc/free.
+ * NUMA placement uses the mbind/get_mempolicy system calls directly (no libnuma to link against); on a single
+ * node machine binding to node 0 or interleaving over {0} works the same way and ds_mem_node_of reports 0.
+ * Everything but plain malloc is Linux only; elsewhere every policy behaves as DS_MEM_MALLOC_POLICY.
+ */
+
+#ifndef DATA_STRUCTURES_MEM_POLICY_H
+#define DATA_STRUCTURES_MEM_POLICY_H
+
+#include <stddef.h> // for size_t
+#include <stdint.h> // for SIZE_MAX && uintptr_t
+#include <stdlib.h> // for malloc && calloc && realloc && free
+#include <string.h> // for memcpy
+
+#include "allocator.h"  // for struct ds_allocator
+
+#ifdef __linux__
+#define DS_MEM_LINUX 1
+#include <sys/mman.h>       // for mmap && mremap && madvise
+#include <sys/syscall.h>    // for SYS_mbind && SYS_get_mempolicy
+#include <unistd.h>         // for syscall
+#endif
+
+enum DS_HUGE_PAGES
+{
+    DS_HUGE_NONE,       // mmap with base pages
+    DS_HUGE_THP,        // huge-page aligned mmap + madvise(MADV_HUGEPAGE)
+    DS_HUGE_HUGETLB,    // MAP_HUGETLB from the reserved pool, DS_HUGE_THP when the pool is empty
+};
+
+enum DS_NUMA_MODE
+{
+    DS_NUMA_DEFAULT,    // first touch
+    DS_NUMA_PREFERRED,  // the first node of `node_mask` if it has memory, any node otherwise
+    DS_NUMA_BIND,       // only the nodes of `node_mask`
+    DS_NUMA_INTERLEAVE, // pages round-robin over the nodes of `node_mask`
+};
+
+struct ds_mem_policy
+{
+    size_t map_threshold;           // blocks of at least this many bytes are mmap'ed, smaller ones come from malloc
+    enum DS_HUGE_PAGES huge_pages;
+    enum DS_NUMA_MODE numa_mode;
+    unsigned long node_mask;        // bit i selects NUMA node i
+};
+
+static const size_t DS_HUGE_PAGE_SIZE = (size_t) 2 << 20;
+
+static const struct ds_mem_policy DS_MEM_MALLOC_POLICY  = {SIZE_MAX, DS_HUGE_NONE, DS_NUMA_DEFAULT, 0};
+static const struct ds_mem_policy DS_MEM_HUGE_POLICY    = {(size_t) 32 << 20, DS_HUGE_THP, DS_NUMA_DEFAULT, 0};
+
+static inline int ds_mem_mapped(struct ds_mem_policy const *policy, size_t bytes)
+{
+#ifdef DS_MEM_LINUX
+    return bytes != 0 && bytes >= policy->map_threshold;
+#else
+    (void) policy;
+    (void) bytes;
+
+    return 0;
+#endif
+}
+
+// Mapped blocks are whole huge pages long whatever the page size, so munmap can find their length again
+static inline size_t ds_mem_map_size(size_t bytes)
+{
+    return (bytes + DS_HUGE_PAGE_SIZE - 1) & ~(DS_HUGE_PAGE_SIZE - 1);
+}
+
+#ifdef DS_MEM_LINUX
+
+// Linux <numaif.h> values, kept here so that no libnuma headers are needed
+static const int DS_MPOL_PREFERRED      = 1;
+static const int DS_MPOL_BIND           = 2;
+static const int DS_MPOL_INTERLEAVE     = 3;
+static const int DS_MPOL_F_NODE         = 1 << 0;
+static const int DS_MPOL_F_ADDR         = 1 << 1;
+
+// Apply the huge page advice && the NUMA policy to a fresh (not yet touched) range
+static inline int ds_mem_advise(struct ds_mem_policy const *policy, void *addr, size_t len)
+{
+    if (policy->huge_pages != DS_HUGE_NONE)
+    {
+        madvise(addr, len, MADV_HUGEPAGE);     // only advice: a kernel without THP keeps base pages
+    }
+
+    if (policy->numa_mode == DS_NUMA_DEFAULT)
+    {
+        return 0;
+    }
+
+    int mode = policy->numa_mode == DS_NUMA_BIND ? DS_MPOL_BIND : policy->numa_mode == DS_NUMA_INTERLEAVE ? DS_MPOL_INTERLEAVE : DS_MPOL_PREFERRED;
+    unsigned long mask = policy->node_mask;
+
+    return syscall(SYS_mbind, addr, len, mode, &mask, sizeof(mask) * 8, 0) != 0;
+}
+
+static inline void *ds_mem_map(struct ds_mem_policy const *policy, size_t bytes)
+{
+    size_t len = ds_mem_map_size(bytes);
+
+    // Reserved huge pages first (the range is huge-page aligned by construction)
+    if (policy->huge_pages == DS_HUGE_HUGETLB)
+    {
+        void *addr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (addr != MAP_FAILED)
+        {
+            if (ds_mem_advise(policy, addr, len))
+            {
+                munmap(addr, len);
+                return NULL;
+            }
+            return addr;
+        }
+    }
+
+    // Map one huge page more than needed && trim, so that the block starts on a huge page boundary
+    char *raw = (char *) mmap(NULL, len + DS_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        return NULL;
+    }
+    char *addr = (char *) (((uintptr_t) raw + DS_HUGE_PAGE_SIZE - 1) & ~(uintptr_t) (DS_HUGE_PAGE_SIZE - 1));
+    if (addr != raw)
+    {
+        munmap(raw, addr - raw);
+    }
+    munmap(addr + len, raw + len + DS_HUGE_PAGE_SIZE - (addr + len));
+
+    if (ds_mem_advise(policy, addr, len))
+    {
+        munmap(addr, len);
+        return NULL;
+    }
+
+    return addr;
+}
+
+#endif // DS_MEM_LINUX
+
+static inline void *ds_mem_alloc(struct ds_mem_policy const *policy, size_t bytes)
+{
+#ifdef DS_MEM_LINUX
+    if (ds_mem_mapped(policy, bytes))
+    {
+        return ds_mem_map(policy, bytes);
+    }
+#endif
+
+    return malloc(bytes);
+}
+
+// Mapped blocks are zero-filled by the kernel, only malloc'ed ones need calloc
+static inline void *ds_mem_calloc(struct ds_mem_policy const *policy, size_t count, size_t size)
+{
+#ifdef DS_MEM_LINUX
+    if (ds_mem_mapped(policy, count * size))
+    {
+        return ds_mem_map(policy, count * size);
+    }
+#endif
+
+    return calloc(count, size);
+}
+
+static inline void ds_mem_free(struct ds_mem_policy const *policy, void *ptr, size_t bytes)
+{
+#ifdef DS_MEM_LINUX
+    if (ptr != NULL && ds_mem_mapped(policy, bytes))
+    {
+        munmap(ptr, ds_mem_map_size(bytes));
+        return;
+    }
+#else
+    (void) policy;
+    (void) bytes;
+#endif
+
+    free(ptr);
+}
+
+/**
+ * @brief realloc counterpart: malloc'ed blocks are realloc'ed, mapped ones are mremap'ed (page tables move, bytes
+ *        do not); crossing the threshold in either direction copies min(old_bytes, new_bytes) bytes.
+ *        On failure returns NULL && leaves `ptr` untouched.
+ */
+static inline void *ds_mem_realloc(struct ds_mem_policy const *policy, void *ptr, size_t old_bytes, size_t new_bytes)
+{
+    int old_mapped = ds_mem_mapped(policy, old_bytes);
+    int new_mapped = ds_mem_mapped(policy, new_bytes);
+
+    if (!old_mapped && !new_mapped)
+    {
+        return realloc(ptr, new_bytes);
+    }
+
+#ifdef DS_MEM_LINUX
+    if (old_mapped && new_mapped)
+    {
+        size_t old_len = ds_mem_map_size(old_bytes);
+        size_t new_len = ds_mem_map_size(new_bytes);
+        if (old_len == new_len)
+        {
+            return ptr;
+        }
+
+        // The grown part is a new range for the kernel: advise it again (the same policy was accepted for the
+        // first part, so the result is not checked)
+        void *addr = mremap(ptr, old_len, new_len, MREMAP_MAYMOVE);
+        if (addr != MAP_FAILED)
+        {
+            if (new_len > old_len)
+            {
+                ds_mem_advise(policy, (char *) addr + old_len, new_len - old_len);
+            }
+            return addr;
+        }
+        // MAP_HUGETLB ranges may refuse to move: copy them
+    }
+#endif
+
+    void *addr = ds_mem_alloc(policy, new_bytes);
+    if (addr == NULL)
+    {
+        return NULL;
+    }
+    memcpy(addr, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+    ds_mem_free(policy, ptr, old_bytes);
+
+    return addr;
+}
+
+static inline void *ds_mem_policy_allocate(void *ctx, size_t bytes)
+{
+    return ds_mem_alloc((struct ds_mem_policy const *) ctx, bytes);
+}
+
+static inline void *ds_mem_policy_reallocate(void *ctx, void *ptr, size_t old_bytes, size_t new_bytes)
+{
+    return ds_mem_realloc((struct ds_mem_policy const *) ctx, ptr, old_bytes, new_bytes);
+}
+
+static inline void ds_mem_policy_deallocate(void *ctx, void *ptr, size_t bytes)
+{
+    ds_mem_free((struct ds_mem_policy const *) ctx, ptr, bytes);
+}
+
+/**
+ * @brief Allocator backed by the policy. Only the pointer is kept: the policy must outlive the containers using it.
+ */
+static inline struct ds_allocator ds_mem_allocator(struct ds_mem_policy const *policy)
+{
+    struct ds_allocator a = {ds_mem_policy_allocate, ds_mem_policy_reallocate, ds_mem_policy_deallocate, (void *) policy};
+
+    return a;
+}
+
+/**
+ * @brief NUMA node that holds the (already touched) page of `addr`, -1 if unknown.
+ */
+static inline int ds_mem_node_of(void const *addr)
+{
+#ifdef DS_MEM_LINUX
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, addr, DS_MPOL_F_NODE | DS_MPOL_F_ADDR) != 0)
+    {
+        return -1;
+    }
+
+    return node;
+#else
+    (void) addr;
+
+    return -1;
+#endif
+}
+
+#endif // DATA_STRUCTURES_MEM_POLICY_H
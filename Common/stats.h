@@ -0,0 +1,230 @@
+/**
+ * @file stats.h
+ * @author Vladislav Skvortsov
+ * @brief Opt-in instrumentation shared by the containers: operation counters, reallocation/shifting counters,
+ *        high-water marks and sampled latency histograms (+ text/JSON dump)
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * Everything is compiled out unless DS_STATS is defined before the container is included (or passed with
+ * -DDS_STATS): the DS_STATS_* macros expand to nothing and the containers carry no extra fields.
+ * Per-instance counters belong to the instance (same threading rules as the container itself);
+ * global counters (one set per container kind) are updated with relaxed atomics.
+ */
+
+#ifndef DATA_STRUCTURES_STATS_H
+#define DATA_STRUCTURES_STATS_H
+
+#ifdef DS_STATS
+
+#include <stddef.h> // for size_t
+#include <stdio.h>  // for fprintf
+#include <string.h> // for memset
+
+#include <chrono>   // for std::chrono (latency samples)
+
+enum DS_STATS_OP
+{
+    DS_OP_PUSH,
+    DS_OP_POP,
+    DS_OP_GET,
+
+    DS_OP_COUNT,
+};
+
+enum DS_STATS_KIND
+{
+    DS_KIND_STACK,
+    DS_KIND_QUEUE,
+    DS_KIND_VECTOR,
+
+    DS_KIND_COUNT,
+};
+
+static const char *const DS_STATS_OP_NAMES[DS_OP_COUNT]     = {"push", "pop", "get"};
+static const char *const DS_STATS_KIND_NAMES[DS_KIND_COUNT] = {"stack", "queue", "vector"};
+
+static const size_t DS_STATS_SAMPLE_PERIOD  = 64;   // every 64th operation of a kind is timed (power of two)
+static const size_t DS_STATS_BUCKETS        = 32;   // bucket i holds latencies in [2^i, 2^(i+1)) ns
+
+struct ds_stats
+{
+    size_t ops[DS_OP_COUNT];
+    size_t reallocs;                // calls of the container reallocation routine
+    size_t bytes_moved;             // bytes relocated by realloc/memmove/memcpy when growing, shrinking or shifting
+    size_t size_high_water;         // greatest number of elements ever held
+    size_t capacity_high_water;     // greatest capacity ever reached (in elements)
+
+    size_t latency[DS_OP_COUNT][DS_STATS_BUCKETS];
+};
+
+inline struct ds_stats ds_global_stats[DS_KIND_COUNT];
+
+static inline void ds_stats_add(size_t *counter, size_t *global_counter, size_t value)
+{
+    *counter += value;
+    __atomic_fetch_add(global_counter, value, __ATOMIC_RELAXED);
+}
+
+static inline void ds_stats_max(size_t *mark, size_t *global_mark, size_t value)
+{
+    if (value > *mark)
+    {
+        *mark = value;
+    }
+
+    size_t seen = __atomic_load_n(global_mark, __ATOMIC_RELAXED);
+    while (value > seen && !__atomic_compare_exchange_n(global_mark, &seen, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+static inline void ds_stats_realloc(struct ds_stats *stats, enum DS_STATS_KIND kind, size_t bytes_moved, size_t new_capacity)
+{
+    struct ds_stats *global = &ds_global_stats[kind];
+
+    ds_stats_add(&stats->reallocs, &global->reallocs, 1);
+    ds_stats_add(&stats->bytes_moved, &global->bytes_moved, bytes_moved);
+    ds_stats_max(&stats->capacity_high_water, &global->capacity_high_water, new_capacity);
+}
+
+// Seeds the capacity mark of a new container, which may never reallocate
+static inline void ds_stats_capacity(struct ds_stats *stats, enum DS_STATS_KIND kind, size_t capacity)
+{
+    ds_stats_max(&stats->capacity_high_water, &ds_global_stats[kind].capacity_high_water, capacity);
+}
+
+static inline void ds_stats_moved(struct ds_stats *stats, enum DS_STATS_KIND kind, size_t bytes_moved)
+{
+    ds_stats_add(&stats->bytes_moved, &ds_global_stats[kind].bytes_moved, bytes_moved);
+}
+
+static inline void ds_stats_size(struct ds_stats *stats, enum DS_STATS_KIND kind, size_t size)
+{
+    ds_stats_max(&stats->size_high_water, &ds_global_stats[kind].size_high_water, size);
+}
+
+/**
+ * @brief Counts one operation and, for every DS_STATS_SAMPLE_PERIOD-th one, times it until the end of the scope.
+ */
+class ds_stats_scope
+{
+public:
+    ds_stats_scope(struct ds_stats *stats, enum DS_STATS_KIND kind, enum DS_STATS_OP op)
+        : stats_(stats), kind_(kind), op_(op), sampled_(false)
+    {
+        size_t count = stats->ops[op]++;
+        __atomic_fetch_add(&ds_global_stats[kind].ops[op], 1, __ATOMIC_RELAXED);
+
+        if ((count & (DS_STATS_SAMPLE_PERIOD - 1)) == 0)
+        {
+            sampled_ = true;
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ds_stats_scope()
+    {
+        if (!sampled_)
+        {
+            return;
+        }
+
+        size_t ns = (size_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+        size_t bucket = 0;
+        while (bucket + 1 < DS_STATS_BUCKETS && (ns >> (bucket + 1)) != 0)
+        {
+            ++bucket;
+        }
+
+        ++stats_->latency[op_][bucket];
+        __atomic_fetch_add(&ds_global_stats[kind_].latency[op_][bucket], 1, __ATOMIC_RELAXED);
+    }
+
+private:
+    struct ds_stats *stats_;
+    enum DS_STATS_KIND kind_;
+    enum DS_STATS_OP op_;
+    bool sampled_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+static inline struct ds_stats const *ds_stats_global(enum DS_STATS_KIND kind)
+{
+    return &ds_global_stats[kind];
+}
+
+inline void ds_stats_dump_text(FILE *out, const char *name, struct ds_stats const *stats)
+{
+    fprintf(out, "%s:\n", name);
+    fprintf(out, "    reallocs: %zu, bytes moved: %zu, size high-water: %zu, capacity high-water: %zu\n",
+            stats->reallocs, stats->bytes_moved, stats->size_high_water, stats->capacity_high_water);
+
+    for (int op = 0; op < DS_OP_COUNT; ++op)
+    {
+        fprintf(out, "    %-4s %zu ops, sampled latency (ns):", DS_STATS_OP_NAMES[op], stats->ops[op]);
+        for (size_t b = 0; b < DS_STATS_BUCKETS; ++b)
+        {
+            if (stats->latency[op][b])
+            {
+                fprintf(out, " [%zu, %zu): %zu", b ? (size_t) 1 << b : 0, (size_t) 1 << (b + 1), stats->latency[op][b]);
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
+
+inline void ds_stats_dump_json(FILE *out, const char *name, struct ds_stats const *stats)
+{
+    fprintf(out, "{\"name\": \"%s\", \"reallocs\": %zu, \"bytes_moved\": %zu, \"size_high_water\": %zu, \"capacity_high_water\": %zu",
+            name, stats->reallocs, stats->bytes_moved, stats->size_high_water, stats->capacity_high_water);
+
+    for (int op = 0; op < DS_OP_COUNT; ++op)
+    {
+        fprintf(out, ", \"%s\": {\"ops\": %zu, \"latency_log2_ns\": [", DS_STATS_OP_NAMES[op], stats->ops[op]);
+        for (size_t b = 0; b < DS_STATS_BUCKETS; ++b)
+        {
+            fprintf(out, "%s%zu", b ? ", " : "", stats->latency[op][b]);
+        }
+        fprintf(out, "]}");
+    }
+    fprintf(out, "}\n");
+}
+
+inline void ds_stats_dump_global(FILE *out, int json)
+{
+    for (int kind = 0; kind < DS_KIND_COUNT; ++kind)
+    {
+        if (json)
+        {
+            ds_stats_dump_json(out, DS_STATS_KIND_NAMES[kind], &ds_global_stats[kind]);
+        }
+        else
+        {
+            ds_stats_dump_text(out, DS_STATS_KIND_NAMES[kind], &ds_global_stats[kind]);
+        }
+    }
+}
+
+#define DS_STATS_FIELD                              mutable struct ds_stats stats;   // mutable: read-only accessors count too
+#define DS_STATS_INIT(obj)                          memset(&(obj)->stats, 0, sizeof((obj)->stats))
+#define DS_STATS_SCOPE(obj, kind, op)               ds_stats_scope ds_stats_scope_guard(&(obj)->stats, kind, op)
+#define DS_STATS_REALLOC(obj, kind, moved, cap)     ds_stats_realloc(&(obj)->stats, kind, moved, cap)
+#define DS_STATS_MOVED(obj, kind, moved)            ds_stats_moved(&(obj)->stats, kind, moved)
+#define DS_STATS_SIZE(obj, kind, size)              ds_stats_size(&(obj)->stats, kind, size)
+#define DS_STATS_CAPACITY(obj, kind, cap)           ds_stats_capacity(&(obj)->stats, kind, cap)
+
+#else
+
+#define DS_STATS_FIELD
+#define DS_STATS_INIT(obj)
+#define DS_STATS_SCOPE(obj, kind, op)
+#define DS_STATS_REALLOC(obj, kind, moved, cap)
+#define DS_STATS_MOVED(obj, kind, moved)
+#define DS_STATS_SIZE(obj, kind, size)
+#define DS_STATS_CAPACITY(obj, kind, cap)
+
+#endif // DS_STATS
+
+#endif // DATA_STRUCTURES_STATS_H
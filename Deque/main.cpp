@@ -0,0 +1,570 @@
+/**
+ * @file main.cpp
+ * @author Vladislav Skvortsov
+ * @brief Implementation of double-ended queue (segmented: a map of fixed-size blocks) with elements of any type support (+ basic interface)
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <assert.h> // for assert
+#include <stddef.h> // for size_t
+#include <stdio.h>  // for printf && putchar
+#include <stdlib.h> // for malloc && free
+#include <string.h> // for memcpy && memmove && strcmp
+
+#include <chrono>   // for std::chrono (benchmark)
+#include <deque>    // for std::deque (benchmark baseline)
+
+#include "../Common/allocator.h"    // for struct ds_allocator (pluggable blocks && map)
+
+/**
+ * @brief Deque of `elem_size` byte elements kept in blocks of `block_elems` elements (a power of two, about
+ *        DEQUE_BLOCK_BYTES per block). The map is an array of block pointers with free room on both sides; the
+ *        elements are the `size` slots starting at offset `head` of block map[first]. Element i lives in block
+ *        (head + i) >> block_shift, so indexing is O(1). A push at either end fills the edge block or adds a new
+ *        one, a pop at either end drops the edge block when it empties: no element is ever moved, so pointers
+ *        to elements stay valid until the element is popped. When the map runs out of room on one side only the
+ *        block pointers are re-centered (or the map doubled), never the elements.
+ */
+struct deque
+{
+    char **map;             // block pointers, the used ones are map[first] .. map[first + blocks - 1]
+    size_t map_capacity;
+    size_t first;           // map index of the block holding element 0
+    size_t blocks;          // blocks in use (0 for an empty deque)
+
+    size_t head;            // slot of element 0 inside map[first]
+    size_t size;
+
+    size_t elem_size;
+    size_t block_elems;     // elements per block, a power of two
+    size_t block_shift;     // log2(block_elems)
+
+    char *spare;            // last released block, reused by the next push that needs one (no malloc/free ping-pong)
+
+    struct ds_allocator allocator;      // where the blocks && the map come from (malloc unless given to deque_new_alloc)
+};
+
+static const size_t DEQUE_BLOCK_BYTES   = 4096;
+static const size_t DEQUE_MIN_BLOCK     = 16;       // elements per block at least, even for big elements
+static const size_t DEQUE_MIN_MAP       = 8;
+
+struct deque *deque_new_alloc(size_t elem_size, struct ds_allocator const *allocator)
+{
+    // Error check
+    assert(elem_size > 0 && allocator != NULL);
+
+    // Construction of `deque` structure (blocks are allocated by the first push)
+    struct deque *d = (struct deque *) calloc(1, sizeof(struct deque));
+    assert(d != NULL);
+
+    d->allocator    = *allocator;
+    d->elem_size    = elem_size;
+    d->block_elems  = DEQUE_MIN_BLOCK;
+    d->block_shift  = 4;
+    while (d->block_elems * 2 * elem_size <= DEQUE_BLOCK_BYTES)
+    {
+        d->block_elems *= 2;
+        d->block_shift += 1;
+    }
+
+    d->map_capacity = DEQUE_MIN_MAP;
+    d->map          = (char **) ds_allocate(&d->allocator, d->map_capacity * sizeof(char *));
+    assert(d->map != NULL);
+    d->first        = d->map_capacity / 2;
+
+    return d;
+}
+
+struct deque *deque_new(size_t elem_size)
+{
+    return deque_new_alloc(elem_size, &DS_DEFAULT_ALLOCATOR);
+}
+
+static void deque_free_block(struct deque *d, char *block)
+{
+    if (d->spare == NULL)
+    {
+        d->spare = block;
+        return;
+    }
+    ds_deallocate(&d->allocator, block, d->block_elems * d->elem_size);
+}
+
+static char *deque_alloc_block(struct deque *d)
+{
+    if (d->spare != NULL)
+    {
+        char *block = d->spare;
+        d->spare = NULL;
+        return block;
+    }
+
+    return (char *) ds_allocate(&d->allocator, d->block_elems * d->elem_size);
+}
+
+struct deque *deque_delete(struct deque *d)
+{
+    // Error check
+    assert(d != NULL);
+
+    // Destruction
+    for (size_t b = 0; b < d->blocks; ++b)
+    {
+        ds_deallocate(&d->allocator, d->map[d->first + b], d->block_elems * d->elem_size);
+    }
+    if (d->spare != NULL)
+    {
+        ds_deallocate(&d->allocator, d->spare, d->block_elems * d->elem_size);
+    }
+    ds_deallocate(&d->allocator, d->map, d->map_capacity * sizeof(char *));
+    free(d);
+
+    return NULL;
+}
+
+static inline char *deque_slot(struct deque const *d, size_t pos)
+{
+    return d->map[d->first + (pos >> d->block_shift)] + (pos & (d->block_elems - 1)) * d->elem_size;
+}
+
+/**
+ * @brief Make room for one more block pointer in front of (`front` = 1) or behind the used ones: re-center them
+ *        if the map is at most half full, otherwise double it. Only pointers move.
+ */
+static int deque_map_reserve(struct deque *d, int front)
+{
+    if (front ? d->first > 0 : d->first + d->blocks < d->map_capacity)
+    {
+        return 0;
+    }
+
+    size_t new_capacity = d->map_capacity;
+    char **new_map = d->map;
+    if (2 * (d->blocks + 1) > d->map_capacity)
+    {
+        new_capacity = 2 * d->map_capacity;
+        new_map = (char **) ds_allocate(&d->allocator, new_capacity * sizeof(char *));
+        if (new_map == NULL)
+        {
+            return 1;
+        }
+    }
+
+    size_t new_first = (new_capacity - d->blocks) / 2;
+    memmove(new_map + new_first, d->map + d->first, d->blocks * sizeof(char *));
+    if (new_map != d->map)
+    {
+        ds_deallocate(&d->allocator, d->map, d->map_capacity * sizeof(char *));
+    }
+    d->map          = new_map;
+    d->map_capacity = new_capacity;
+    d->first        = new_first;
+
+    return 0;
+}
+
+// Drop every block of an emptied deque (the last one is kept as the spare) && re-center
+static void deque_release_all(struct deque *d)
+{
+    for (size_t b = 0; b < d->blocks; ++b)
+    {
+        deque_free_block(d, d->map[d->first + b]);
+    }
+    d->blocks   = 0;
+    d->head     = 0;
+    d->first    = d->map_capacity / 2;
+}
+
+//-----------------------------------------------------INTERFACE------------------------------------------------------
+
+// Uninitialized new last slot to be filled in place, NULL if no block can be allocated
+void *deque_emplace_back(struct deque *d)
+{
+    // Error check
+    assert(d != NULL);
+
+    size_t pos = d->head + d->size;
+    if (pos == d->blocks << d->block_shift)
+    {
+        char *block = NULL;
+        if (deque_map_reserve(d, 0) || (block = deque_alloc_block(d)) == NULL)
+        {
+            return NULL;
+        }
+        d->map[d->first + d->blocks++] = block;
+    }
+    ++d->size;
+
+    return deque_slot(d, pos);
+}
+
+// Uninitialized new first slot to be filled in place, NULL if no block can be allocated
+void *deque_emplace_front(struct deque *d)
+{
+    // Error check
+    assert(d != NULL);
+
+    if (d->head == 0)
+    {
+        char *block = NULL;
+        if (deque_map_reserve(d, 1) || (block = deque_alloc_block(d)) == NULL)
+        {
+            return NULL;
+        }
+        // An empty deque has no block to extend: the new one becomes map[first] itself
+        d->first   -= d->blocks != 0;
+        d->map[d->first] = block;
+        d->blocks  += 1;
+        d->head     = d->block_elems;
+    }
+    --d->head;
+    ++d->size;
+
+    return deque_slot(d, d->head);
+}
+
+int deque_push_back(struct deque *d, void const *elem)
+{
+    // Error check
+    assert(elem != NULL);
+
+    void *slot = deque_emplace_back(d);
+    if (slot == NULL)
+    {
+        return 1;
+    }
+    memcpy(slot, elem, d->elem_size);
+
+    return 0;
+}
+
+int deque_push_front(struct deque *d, void const *elem)
+{
+    // Error check
+    assert(elem != NULL);
+
+    void *slot = deque_emplace_front(d);
+    if (slot == NULL)
+    {
+        return 1;
+    }
+    memcpy(slot, elem, d->elem_size);
+
+    return 0;
+}
+
+// `elem` may be NULL to just drop the element
+int deque_pop_back(struct deque *d, void *elem)
+{
+    // Error check
+    assert(d != NULL);
+
+    if (d->size == 0)
+    {
+        return 1;
+    }
+
+    --d->size;
+    if (elem != NULL)
+    {
+        memcpy(elem, deque_slot(d, d->head + d->size), d->elem_size);
+    }
+
+    // Release the last block once nothing lives in it
+    if (d->size == 0)
+    {
+        deque_release_all(d);
+    }
+    else if (d->head + d->size <= (d->blocks - 1) << d->block_shift)
+    {
+        deque_free_block(d, d->map[d->first + --d->blocks]);
+    }
+
+    return 0;
+}
+
+// `elem` may be NULL to just drop the element
+int deque_pop_front(struct deque *d, void *elem)
+{
+    // Error check
+    assert(d != NULL);
+
+    if (d->size == 0)
+    {
+        return 1;
+    }
+
+    if (elem != NULL)
+    {
+        memcpy(elem, deque_slot(d, d->head), d->elem_size);
+    }
+    ++d->head;
+    --d->size;
+
+    // Release the first block once nothing lives in it
+    if (d->size == 0)
+    {
+        deque_release_all(d);
+    }
+    else if (d->head == d->block_elems)
+    {
+        deque_free_block(d, d->map[d->first++]);
+        --d->blocks;
+        d->head = 0;
+    }
+
+    return 0;
+}
+
+// Pointer to element `index` (0 is the front), NULL if out of range; valid until that element is popped
+void *deque_at(struct deque *d, size_t index)
+{
+    // Error check
+    assert(d != NULL);
+
+    if (index >= d->size)
+    {
+        return NULL;
+    }
+
+    return deque_slot(d, d->head + index);
+}
+
+int deque_get(struct deque const *d, size_t index, void *elem)
+{
+    // Error check
+    assert(d != NULL && elem != NULL);
+
+    if (index >= d->size)
+    {
+        return 1;
+    }
+    memcpy(elem, deque_slot(d, d->head + index), d->elem_size);
+
+    return 0;
+}
+
+int deque_set(struct deque *d, size_t index, void const *elem)
+{
+    // Error check
+    assert(d != NULL && elem != NULL);
+
+    if (index >= d->size)
+    {
+        return 1;
+    }
+    memcpy(deque_slot(d, d->head + index), elem, d->elem_size);
+
+    return 0;
+}
+
+void *deque_front_ptr(struct deque *d)
+{
+    return deque_at(d, 0);
+}
+
+void *deque_back_ptr(struct deque *d)
+{
+    return d->size != 0 ? deque_at(d, d->size - 1) : NULL;
+}
+
+// Remove every element (blocks are released, the map is kept)
+void deque_clear(struct deque *d)
+{
+    // Error check
+    assert(d != NULL);
+
+    d->size = 0;
+    deque_release_all(d);
+}
+
+size_t deque_size(struct deque const *d)
+{
+    return d->size;
+}
+
+int deque_empty(struct deque const *d)
+{
+    return !d->size;
+}
+
+void deque_print(struct deque const *d, void (*pf)(void const *data))
+{
+    // Error check
+    assert(d != NULL);
+
+    // Printing, front to back
+    putchar('[');
+    for (size_t i = 0; i < d->size; ++i)
+    {
+        pf(deque_slot(d, d->head + i));
+        if (i + 1 < d->size)
+        {
+            printf(", ");
+        }
+    }
+    printf("]\n");
+}
+
+//------------------------------------------------------TESTING-------------------------------------------------------
+
+// Define DATA_STRUCTURES_NO_MAIN to include this file into another program (see Benchmark/main.cpp)
+#ifndef DATA_STRUCTURES_NO_MAIN
+
+static void deque_print_int(void const *element)
+{
+    printf("%d", *((int const *) element));
+}
+
+/**
+ * @brief Sliding window maximum: `out[i]` = max of data[i .. i + window - 1]. The deque keeps indices of
+ *        decreasing values: new ones come in at the back (dropping smaller ones there), expired ones leave
+ *        at the front, so each index is pushed && popped once.
+ */
+static void deque_window_max(struct deque *d, int const *data, size_t n, size_t window, int *out)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        while (!deque_empty(d) && data[*(size_t *) deque_back_ptr(d)] <= data[i])
+        {
+            deque_pop_back(d, NULL);
+        }
+        deque_push_back(d, &i);
+
+        if (*(size_t *) deque_front_ptr(d) + window <= i)
+        {
+            deque_pop_front(d, NULL);
+        }
+        if (i + 1 >= window)
+        {
+            out[i + 1 - window] = data[*(size_t *) deque_front_ptr(d)];
+        }
+    }
+}
+
+static double deque_elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Sliding window of `window` ints over `n` steps (push back, pop front, read a random element) against std::deque
+static void deque_benchmark(size_t n, size_t window)
+{
+    double ns[2];
+    long long checksum[2] = {0, 0};
+
+    struct deque *d = deque_new(sizeof(int));
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < (int) n; ++i)
+    {
+        deque_push_back(d, &i);
+        if (deque_size(d) > window)
+        {
+            deque_pop_front(d, NULL);
+        }
+        checksum[0] += *(int *) deque_at(d, (size_t) i * 7919 % deque_size(d));
+    }
+    ns[0] = deque_elapsed_ns(start);
+    d = deque_delete(d);
+
+    std::deque<int> sd;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < (int) n; ++i)
+    {
+        sd.push_back(i);
+        if (sd.size() > window)
+        {
+            sd.pop_front();
+        }
+        checksum[1] += sd[(size_t) i * 7919 % sd.size()];
+    }
+    ns[1] = deque_elapsed_ns(start);
+
+    printf("window %8zu, %zu steps: deque %6.2lf ns/step, std::deque %6.2lf ns/step%s\n", window, n, ns[0] / n, ns[1] / n,
+           checksum[0] == checksum[1] ? "" : " (checksums differ)");
+}
+
+// Should print [-3, -2, -1, 0, 1, 2]
+//              window max: 3 3 5 5 6 7
+//              100000 pushes at both ends, front pointer stable: 1, [0] = -50000, [99999] = 49999
+//
+// Run with `--bench` to compare a sliding window workload with std::deque
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        deque_benchmark(50000000, 100);
+        deque_benchmark(50000000, 100000);
+        deque_benchmark(50000000, 10000000);
+
+        return 0;
+    }
+
+    struct deque *d = deque_new(sizeof(int));
+    for (int i = 0; i < 3; ++i)
+    {
+        deque_push_back(d, &i);
+        int neg = -i - 1;
+        deque_push_front(d, &neg);
+    }
+    int elem = 0;
+    deque_pop_back(d, &elem);
+    int three = 3;
+    deque_push_front(d, &three);
+    deque_pop_front(d, NULL);
+    deque_push_back(d, &elem);
+    deque_print(d, deque_print_int);
+    d = deque_delete(d);
+
+    // Monotonic deque of indices
+    const int data[] = {1, 3, -1, -3, 5, 3, 6, 7};
+    const size_t window = 3, n = sizeof(data) / sizeof(data[0]);
+    int window_max[n - window + 1];
+    d = deque_new(sizeof(size_t));
+    deque_window_max(d, data, n, window, window_max);
+    printf("window max:");
+    for (size_t i = 0; i + window <= n; ++i)
+    {
+        printf(" %d", window_max[i]);
+    }
+    putchar('\n');
+    d = deque_delete(d);
+
+    // Growth at both ends adds blocks && re-centers the map, the elements themselves never move
+    d = deque_new(sizeof(int));
+    int zero = 0;
+    deque_push_back(d, &zero);
+    int *front = (int *) deque_front_ptr(d);
+    for (int i = 1; i < 50000; ++i)
+    {
+        int neg = -i;
+        deque_push_back(d, &i);
+        deque_push_front(d, &neg);
+    }
+    int neg = -50000;
+    deque_push_front(d, &neg);
+    int first = 0, last = 0;
+    deque_get(d, 0, &first);
+    deque_get(d, deque_size(d) - 1, &last);
+    printf("%zu pushes at both ends, front pointer stable: %d, [0] = %d, [%zu] = %d\n", deque_size(d),
+           front == deque_at(d, 50000) && *front == 0, first, deque_size(d) - 1, last);
+    d = deque_delete(d);
+
+    return 0;
+}
+
+#endif // DATA_STRUCTURES_NO_MAIN
+
+/**
+ * @brief   deque_push_back / deque_push_front / deque_emplace_* - O(1): a new block at most, plus O(blocks) pointer
+ *              moves when the map has to be re-centered or doubled (amortized O(1 / block_elems) per push),
+ *          deque_pop_back / deque_pop_front - O(1), an emptied edge block is released (one is cached for reuse),
+ *          deque_at / deque_get / deque_set - O(1): a shift && a mask find the block && the slot,
+ *          deque_clear - O(blocks),
+ *          no operation moves elements, so pointers to them stay valid until they are popped.
+ *
+ */
@@ -0,0 +1,802 @@
+/**
+ * @file main.cpp
+ * @author Vladislav Skvortsov
+ * @brief Implementation of hash map (open addressing, SwissTable-style) data structure with keys && values of any type support (+ basic interface)
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+// Control bytes && entries live in `struct vector`s; the vector demo must not end up in this program
+#ifdef DATA_STRUCTURES_NO_MAIN
+#include "../Vector/main.cpp"
+#else
+#define DATA_STRUCTURES_NO_MAIN
+#include "../Vector/main.cpp"
+#undef DATA_STRUCTURES_NO_MAIN
+#endif
+
+#include <assert.h> // for assert
+#include <stddef.h> // for size_t && max_align_t
+#include <stdint.h> // for uint8_t && uint32_t && uint64_t
+#include <stdio.h>  // for printf
+#include <stdlib.h> // for malloc && free
+#include <string.h> // for memcpy && memcmp && memset && strcmp
+
+#include <chrono>           // for std::chrono (benchmark)
+#include <random>           // for std::mt19937_64 (benchmark)
+#include <unordered_map>    // for std::unordered_map (benchmark baseline)
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>      // for SSE2 intrinsics (control byte groups)
+#define HASHMAP_SSE2 1
+#endif
+
+/**
+ * @brief Open-addressing hash map of `key_size` byte keys to `value_size` byte values (SwissTable layout). Every slot
+ *        has a control byte: EMPTY, DELETED (tombstone) or, for a full slot, the low 7 bits of its hash (h2).
+ *        Slots are probed a group of HASHMAP_GROUP_WIDTH at a time: one SSE2 compare of the group's control bytes
+ *        against h2 yields a bit mask of candidates, so a lookup usually compares a single key, and a group with
+ *        an EMPTY byte ends the probe. Groups are visited in triangular order from the group picked by the rest
+ *        of the hash (h1), which reaches every group of the power-of-two sized table.
+ *        Keys are hashed && compared by user callbacks (bytewise when NULL); compare returns 0 for equal keys,
+ *        like the list comparators. Pointers to keys && values stay valid until the next insertion or rehash.
+ */
+typedef uint64_t (*hashmap_hash)(void const *key, size_t key_size);
+typedef int (*hashmap_cmp)(void const *key, void const *other);
+
+struct hashmap
+{
+    struct vector *ctrl;        // uint8_t control byte per slot
+    struct vector *entries;     // `entry_size` bytes per slot: the key, then the value at `value_offset`
+
+    size_t key_size;
+    size_t value_size;
+    size_t value_offset;        // the value is aligned for its size
+    size_t entry_size;
+
+    size_t size;                // full slots
+    size_t tombstones;          // DELETED slots, they lengthen probes until the next rehash
+    size_t capacity;            // slots, a power of two && a multiple of HASHMAP_GROUP_WIDTH (0 before the first insert)
+    size_t growth_left;         // insertions into EMPTY slots before the load factor is exceeded (max used - size - tombstones)
+
+    double max_load_factor;     // (size + tombstones) / capacity never goes above it
+
+    hashmap_hash hash;
+    hashmap_cmp cmp;
+};
+
+static const size_t  HASHMAP_GROUP_WIDTH        = 16;
+static const double  HASHMAP_DEFAULT_LOAD       = 0.875;    // 14 of 16 slots of a group
+static const uint8_t HASHMAP_EMPTY              = 0x80;
+static const uint8_t HASHMAP_DELETED            = 0xFE;     // EMPTY && DELETED have the top bit set, full slots do not
+
+//------------------------------------------------------HASHING-------------------------------------------------------
+
+static inline uint64_t hashmap_mix(uint64_t h)
+{
+    // Final step of MurmurHash3: every input bit affects h1 && h2 (protects against identity hashes of integers)
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+// Default hash: the key bytes, 8 at a time
+uint64_t hashmap_hash_bytes(void const *key, size_t key_size)
+{
+    unsigned char const *bytes = (unsigned char const *) key;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ key_size;
+
+    size_t i = 0;
+    for (; i + 8 <= key_size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        h = (h ^ word) * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+    }
+    if (i < key_size)
+    {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, key_size - i);
+        h = (h ^ word) * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+    }
+
+    return h;
+}
+
+//-------------------------------------------------------GROUPS-------------------------------------------------------
+
+// Bit i is set if control byte i of the group equals `byte`
+static inline uint32_t hashmap_group_match(uint8_t const *group, uint8_t byte)
+{
+#ifdef HASHMAP_SSE2
+    __m128i ctrl = _mm_loadu_si128((__m128i const *) group);
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char) byte)));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < HASHMAP_GROUP_WIDTH; ++i)
+    {
+        mask |= (uint32_t) (group[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+// Bit i is set if slot i of the group is EMPTY or DELETED
+static inline uint32_t hashmap_group_free(uint8_t const *group)
+{
+#ifdef HASHMAP_SSE2
+    return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((__m128i const *) group));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < HASHMAP_GROUP_WIDTH; ++i)
+    {
+        mask |= (uint32_t) (group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline unsigned hashmap_lowest_bit(uint32_t mask)
+{
+    return (unsigned) __builtin_ctz(mask);
+}
+
+//-----------------------------------------------------STRUCTURE------------------------------------------------------
+
+static inline uint8_t *hashmap_ctrl(struct hashmap *map)
+{
+    return (uint8_t *) vector_data(map->ctrl);
+}
+
+static inline char *hashmap_entry(struct hashmap *map, size_t slot)
+{
+    return (char *) vector_data(map->entries) + slot * map->entry_size;
+}
+
+// Natural alignment of an object of `size` bytes: its largest power-of-two divisor, at most alignof(max_align_t)
+static size_t hashmap_align_of(size_t size)
+{
+    size_t align = 1;
+    while (align < alignof(max_align_t) && size % (align * 2) == 0)
+    {
+        align *= 2;
+    }
+
+    return align;
+}
+
+static int hashmap_cmp_bytes(struct hashmap const *map, void const *key, void const *other)
+{
+    return map->cmp != NULL ? map->cmp(key, other) : memcmp(key, other, map->key_size);
+}
+
+static inline uint64_t hashmap_hash_key(struct hashmap const *map, void const *key)
+{
+    return hashmap_mix(map->hash != NULL ? map->hash(key, map->key_size) : hashmap_hash_bytes(key, map->key_size));
+}
+
+struct hashmap *hashmap_new(size_t key_size, size_t value_size, hashmap_hash hash, hashmap_cmp cmp)
+{
+    // Error check
+    assert(key_size > 0);
+
+    // Construction of `hashmap` structure (the slots are allocated by the first insertion)
+    struct hashmap *map = (struct hashmap *) calloc(1, sizeof(struct hashmap));
+    assert(map != NULL);
+
+    size_t value_align = value_size != 0 ? hashmap_align_of(value_size) : 1;
+    size_t key_align   = hashmap_align_of(key_size);
+    size_t entry_align = key_align > value_align ? key_align : value_align;
+
+    map->key_size        = key_size;
+    map->value_size      = value_size;
+    map->value_offset    = (key_size + value_align - 1) / value_align * value_align;
+    map->entry_size      = (map->value_offset + value_size + entry_align - 1) / entry_align * entry_align;
+    map->max_load_factor = HASHMAP_DEFAULT_LOAD;
+    map->hash            = hash;
+    map->cmp             = cmp;
+
+    return map;
+}
+
+struct hashmap *hashmap_delete(struct hashmap *map)
+{
+    // Error check
+    assert(map != NULL);
+
+    // Destruction
+    if (map->capacity != 0)
+    {
+        map->ctrl       = vector_delete(map->ctrl);
+        map->entries    = vector_delete(map->entries);
+    }
+    free(map);
+
+    return NULL;
+}
+
+// Slots that may be taken (full or DELETED) in a table of `capacity` slots
+static size_t hashmap_max_used(struct hashmap const *map, size_t capacity)
+{
+    size_t max_used = (size_t) (map->max_load_factor * (double) capacity);
+
+    return max_used < capacity ? max_used : capacity - 1;     // one EMPTY slot at least ends every miss
+}
+
+// Smallest table that holds `count` elements within the load factor
+static size_t hashmap_capacity_for(struct hashmap const *map, size_t count)
+{
+    size_t capacity = HASHMAP_GROUP_WIDTH;
+    while (hashmap_max_used(map, capacity) < count)
+    {
+        capacity *= 2;
+    }
+
+    return capacity;
+}
+
+//-------------------------------------------------------PROBING------------------------------------------------------
+
+// Slot of `key`, `map->capacity` if it is absent
+static size_t hashmap_find_slot(struct hashmap *map, void const *key, uint64_t hash)
+{
+    if (map->capacity == 0)
+    {
+        return 0;
+    }
+
+    uint8_t const *ctrl = hashmap_ctrl(map);
+    uint8_t h2          = (uint8_t) (hash & 0x7F);
+    size_t group_mask   = map->capacity / HASHMAP_GROUP_WIDTH - 1;
+    size_t group        = (size_t) (hash >> 7) & group_mask;
+
+    for (size_t step = 1; ; ++step)
+    {
+        uint8_t const *g = ctrl + group * HASHMAP_GROUP_WIDTH;
+        for (uint32_t match = hashmap_group_match(g, h2); match != 0; match &= match - 1)
+        {
+            size_t slot = group * HASHMAP_GROUP_WIDTH + hashmap_lowest_bit(match);
+            if (hashmap_cmp_bytes(map, hashmap_entry(map, slot), key) == 0)
+            {
+                return slot;
+            }
+        }
+
+        // An EMPTY byte: the key would have been put here at the latest
+        if (hashmap_group_match(g, HASHMAP_EMPTY) != 0 || step > group_mask)
+        {
+            return map->capacity;
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+// First EMPTY or DELETED slot on the probe sequence of `hash` (the table is never full)
+static size_t hashmap_free_slot(struct hashmap *map, uint64_t hash)
+{
+    uint8_t const *ctrl = hashmap_ctrl(map);
+    size_t group_mask   = map->capacity / HASHMAP_GROUP_WIDTH - 1;
+    size_t group        = (size_t) (hash >> 7) & group_mask;
+
+    for (size_t step = 1; ; ++step)
+    {
+        uint32_t free_mask = hashmap_group_free(ctrl + group * HASHMAP_GROUP_WIDTH);
+        if (free_mask != 0)
+        {
+            return group * HASHMAP_GROUP_WIDTH + hashmap_lowest_bit(free_mask);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+// Move every element into a fresh table of `new_capacity` slots (dropping the tombstones)
+static int hashmap_resize(struct hashmap *map, size_t new_capacity)
+{
+    struct vector *new_ctrl     = vector_new(new_capacity, sizeof(uint8_t));
+    struct vector *new_entries  = vector_new(new_capacity, map->entry_size);
+    memset(vector_data(new_ctrl), HASHMAP_EMPTY, new_capacity);
+
+    struct hashmap old = *map;
+    map->ctrl           = new_ctrl;
+    map->entries        = new_entries;
+    map->capacity       = new_capacity;
+    map->tombstones     = 0;
+    map->growth_left    = hashmap_max_used(map, new_capacity) - map->size;
+
+    // The keys are known to be distinct: no lookup, just the first free slot of each probe sequence
+    for (size_t slot = 0; slot < old.capacity; ++slot)
+    {
+        if (hashmap_ctrl(&old)[slot] & 0x80)
+        {
+            continue;
+        }
+
+        char const *entry = hashmap_entry(&old, slot);
+        uint64_t hash = hashmap_hash_key(map, entry);
+        size_t new_slot = hashmap_free_slot(map, hash);
+        hashmap_ctrl(map)[new_slot] = (uint8_t) (hash & 0x7F);
+        memcpy(hashmap_entry(map, new_slot), entry, map->entry_size);
+    }
+
+    if (old.capacity != 0)
+    {
+        vector_delete(old.ctrl);
+        vector_delete(old.entries);
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------INTERFACE------------------------------------------------------
+
+/**
+ * @brief Make room for `count` elements without rehashing. Never shrinks the table.
+ */
+int hashmap_reserve(struct hashmap *map, size_t count)
+{
+    // Error check
+    assert(map != NULL);
+
+    size_t capacity = hashmap_capacity_for(map, count);
+    if (capacity <= map->capacity)
+    {
+        return 0;
+    }
+
+    return hashmap_resize(map, capacity);
+}
+
+/**
+ * @brief Rebuild the table with at least `capacity` slots (rounded up to what the elements need), dropping the
+ *        tombstones. hashmap_rehash(map, 0) shrinks the table to fit.
+ */
+int hashmap_rehash(struct hashmap *map, size_t capacity)
+{
+    // Error check
+    assert(map != NULL);
+
+    size_t needed = hashmap_capacity_for(map, map->size);
+    while (needed < capacity)
+    {
+        needed *= 2;
+    }
+
+    return hashmap_resize(map, needed);
+}
+
+// `load_factor` in (0, 1): higher saves memory, lower shortens probes; takes effect at once
+int hashmap_set_max_load_factor(struct hashmap *map, double load_factor)
+{
+    // Error check
+    assert(map != NULL);
+
+    if (!(load_factor > 0.0 && load_factor < 1.0))
+    {
+        return 1;
+    }
+    map->max_load_factor = load_factor;
+
+    if (map->capacity == 0)
+    {
+        return 0;
+    }
+
+    // Grow if the elements no longer fit, clean up if the tombstones no longer do
+    size_t capacity = hashmap_capacity_for(map, map->size);
+    size_t max_used = hashmap_max_used(map, map->capacity);
+    if (capacity > map->capacity || max_used < map->size + map->tombstones)
+    {
+        return hashmap_resize(map, capacity > map->capacity ? capacity : map->capacity);
+    }
+    map->growth_left = max_used - map->size - map->tombstones;
+
+    return 0;
+}
+
+double hashmap_load_factor(struct hashmap const *map)
+{
+    return map->capacity == 0 ? 0.0 : (double) map->size / (double) map->capacity;
+}
+
+/**
+ * @brief Slot for `key`, inserted with an undefined value if it is absent (`*inserted` tells which, may be NULL).
+ *        Returns a pointer to the value to be filled in place, NULL if the table can't grow.
+ */
+void *hashmap_emplace(struct hashmap *map, void const *key, int *inserted)
+{
+    // Error check
+    assert(map != NULL && key != NULL);
+
+    uint64_t hash = hashmap_hash_key(map, key);
+    size_t slot = hashmap_find_slot(map, key, hash);
+    if (slot < map->capacity)
+    {
+        if (inserted != NULL)
+        {
+            *inserted = 0;
+        }
+        return hashmap_entry(map, slot) + map->value_offset;
+    }
+
+    // Reusing a tombstone costs no growth; a new EMPTY slot may need a bigger (or just cleaned up) table first
+    slot = map->capacity != 0 ? hashmap_free_slot(map, hash) : 0;
+    if (map->capacity == 0 || (hashmap_ctrl(map)[slot] == HASHMAP_EMPTY && map->growth_left == 0))
+    {
+        size_t capacity = hashmap_capacity_for(map, map->size + 1);
+        if (capacity < map->capacity)
+        {
+            capacity = map->capacity;
+        }
+        if (capacity == map->capacity && map->tombstones < map->capacity / 8)
+        {
+            capacity *= 2;      // few tombstones to win back: grow instead of rehashing in place over && over
+        }
+        if (hashmap_resize(map, capacity))
+        {
+            return NULL;
+        }
+        slot = hashmap_free_slot(map, hash);
+    }
+
+    if (hashmap_ctrl(map)[slot] == HASHMAP_DELETED)
+    {
+        --map->tombstones;
+    }
+    else
+    {
+        --map->growth_left;
+    }
+    hashmap_ctrl(map)[slot] = (uint8_t) (hash & 0x7F);
+    ++map->size;
+
+    char *entry = hashmap_entry(map, slot);
+    memcpy(entry, key, map->key_size);
+    if (inserted != NULL)
+    {
+        *inserted = 1;
+    }
+
+    return entry + map->value_offset;
+}
+
+// Insert `key` or overwrite its value; returns 0 on success
+int hashmap_insert(struct hashmap *map, void const *key, void const *value)
+{
+    void *slot_value = hashmap_emplace(map, key, NULL);
+    if (slot_value == NULL)
+    {
+        return 1;
+    }
+    if (map->value_size != 0)
+    {
+        memcpy(slot_value, value, map->value_size);
+    }
+
+    return 0;
+}
+
+// Pointer to the value of `key`, NULL if it is absent
+void *hashmap_find(struct hashmap *map, void const *key)
+{
+    // Error check
+    assert(map != NULL && key != NULL);
+
+    size_t slot = hashmap_find_slot(map, key, hashmap_hash_key(map, key));
+
+    return slot < map->capacity ? hashmap_entry(map, slot) + map->value_offset : NULL;
+}
+
+int hashmap_contains(struct hashmap *map, void const *key)
+{
+    return hashmap_find(map, key) != NULL;
+}
+
+// Copy the value of `key` to `value`; returns 1 if it is absent
+int hashmap_get(struct hashmap *map, void const *key, void *value)
+{
+    void const *found = hashmap_find(map, key);
+    if (found == NULL)
+    {
+        return 1;
+    }
+    memcpy(value, found, map->value_size);
+
+    return 0;
+}
+
+int hashmap_erase(struct hashmap *map, void const *key)
+{
+    // Error check
+    assert(map != NULL && key != NULL);
+
+    size_t slot = hashmap_find_slot(map, key, hashmap_hash_key(map, key));
+    if (slot >= map->capacity)
+    {
+        return 1;
+    }
+
+    // A group with an EMPTY slot has never been full, so no probe went past it: the slot can become EMPTY again
+    uint8_t *group = hashmap_ctrl(map) + slot / HASHMAP_GROUP_WIDTH * HASHMAP_GROUP_WIDTH;
+    if (hashmap_group_match(group, HASHMAP_EMPTY) != 0)
+    {
+        hashmap_ctrl(map)[slot] = HASHMAP_EMPTY;
+        ++map->growth_left;
+    }
+    else
+    {
+        hashmap_ctrl(map)[slot] = HASHMAP_DELETED;
+        ++map->tombstones;
+    }
+    --map->size;
+
+    return 0;
+}
+
+// Remove every element, keeping the table
+void hashmap_clear(struct hashmap *map)
+{
+    // Error check
+    assert(map != NULL);
+
+    if (map->capacity != 0)
+    {
+        memset(hashmap_ctrl(map), HASHMAP_EMPTY, map->capacity);
+        map->growth_left = hashmap_max_used(map, map->capacity);
+    }
+    map->size       = 0;
+    map->tombstones = 0;
+}
+
+size_t hashmap_size(struct hashmap const *map)
+{
+    return map->size;
+}
+
+int hashmap_empty(struct hashmap const *map)
+{
+    return !map->size;
+}
+
+//-----------------------------------------------------ITERATION------------------------------------------------------
+
+/**
+ * @brief Iteration in slot order: `for (pos = hashmap_begin(m); pos != hashmap_end(m); pos = hashmap_next(m, pos))`,
+ *        with hashmap_key/hashmap_value at `pos`. Erasing the element at `pos` during the loop is allowed,
+ *        inserting is not (it may rehash).
+ */
+static size_t hashmap_skip_free(struct hashmap *map, size_t slot)
+{
+    // Whole groups at a time: the mask of full slots is the complement of the free ones
+    while (slot < map->capacity)
+    {
+        size_t group_start = slot / HASHMAP_GROUP_WIDTH * HASHMAP_GROUP_WIDTH;
+        uint32_t full = ~hashmap_group_free(hashmap_ctrl(map) + group_start) & 0xFFFF;
+        full &= ~0u << (slot - group_start);
+        if (full != 0)
+        {
+            return group_start + hashmap_lowest_bit(full);
+        }
+        slot = group_start + HASHMAP_GROUP_WIDTH;
+    }
+
+    return map->capacity;
+}
+
+size_t hashmap_begin(struct hashmap *map)
+{
+    return hashmap_skip_free(map, 0);
+}
+
+size_t hashmap_end(struct hashmap const *map)
+{
+    return map->capacity;
+}
+
+size_t hashmap_next(struct hashmap *map, size_t pos)
+{
+    return hashmap_skip_free(map, pos + 1);
+}
+
+void const *hashmap_key(struct hashmap *map, size_t pos)
+{
+    return hashmap_entry(map, pos);
+}
+
+void *hashmap_value(struct hashmap *map, size_t pos)
+{
+    return hashmap_entry(map, pos) + map->value_offset;
+}
+
+//------------------------------------------------------TESTING-------------------------------------------------------
+
+// Define DATA_STRUCTURES_NO_MAIN to include this file into another program (see Benchmark/main.cpp)
+#ifndef DATA_STRUCTURES_NO_MAIN
+
+// String keys: the map stores the pointer, hash && compare look at the characters
+static uint64_t hashmap_hash_string(void const *key, size_t key_size)
+{
+    char const *str = *(char const * const *) key;
+    (void) key_size;
+
+    return hashmap_hash_bytes(str, strlen(str));
+}
+
+static int hashmap_cmp_string(void const *key, void const *other)
+{
+    return strcmp(*(char const * const *) key, *(char const * const *) other);
+}
+
+static double hashmap_elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief uint64_t -> uint64_t throughput on `n` random keys against std::unordered_map: insert all, look up all
+ *        (hits), look up as many absent keys (misses), erase all. Hits && erases go in a scrambled order, so that
+ *        std::unordered_map nodes allocated one after another are not visited one after another.
+ */
+static void hashmap_benchmark(size_t n)
+{
+    std::mt19937_64 rng(n);
+    uint64_t *keys = (uint64_t *) malloc(2 * n * sizeof(uint64_t));
+    assert(keys != NULL);
+    for (size_t i = 0; i < 2 * n; ++i)
+    {
+        keys[i] = rng();
+    }
+    uint64_t const *missing = keys + n;
+    const size_t STRIDE = 1000003;     // prime, coprime with the benchmark sizes
+
+    double ns[2][4];
+    uint64_t checksum[2] = {0, 0};
+
+    struct hashmap *map = hashmap_new(sizeof(uint64_t), sizeof(uint64_t), NULL, NULL);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+    {
+        hashmap_insert(map, &keys[i], &i);
+    }
+    ns[0][0] = hashmap_elapsed_ns(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+    {
+        checksum[0] += *(uint64_t *) hashmap_find(map, &keys[i * STRIDE % n]);
+    }
+    ns[0][1] = hashmap_elapsed_ns(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+    {
+        checksum[0] += hashmap_find(map, &missing[i]) != NULL;
+    }
+    ns[0][2] = hashmap_elapsed_ns(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+    {
+        hashmap_erase(map, &keys[i * STRIDE % n]);
+    }
+    ns[0][3] = hashmap_elapsed_ns(start);
+    map = hashmap_delete(map);
+
+    {
+        std::unordered_map<uint64_t, uint64_t> um;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i)
+        {
+            um[keys[i]] = i;
+        }
+        ns[1][0] = hashmap_elapsed_ns(start);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i)
+        {
+            checksum[1] += um.find(keys[i * STRIDE % n])->second;
+        }
+        ns[1][1] = hashmap_elapsed_ns(start);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i)
+        {
+            checksum[1] += um.find(missing[i]) != um.end();
+        }
+        ns[1][2] = hashmap_elapsed_ns(start);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i)
+        {
+            um.erase(keys[i * STRIDE % n]);
+        }
+        ns[1][3] = hashmap_elapsed_ns(start);
+    }
+    free(keys);
+
+    static const char *names[] = {"hashmap", "std::unordered_map"};
+    for (int impl = 0; impl < 2; ++impl)
+    {
+        printf("%-18s %9zu keys: insert %7.2lf, hit %7.2lf, miss %7.2lf, erase %7.2lf ns/op%s\n", names[impl], n,
+               ns[impl][0] / n, ns[impl][1] / n, ns[impl][2] / n, ns[impl][3] / n, checksum[impl] == checksum[0] ? "" : " (wrong checksum)");
+    }
+}
+
+// Should print size 1000, 500 -> 250000, 1000 missing: 1
+//              after erase: size 500, 500 present: 0, load factor 0.24
+//              iterated 500 keys, sum of squares 166666500
+//              words: apple 3, banana 2, cherry 1
+//
+// Run with `--bench` to compare insert/find/erase throughput with std::unordered_map
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        hashmap_benchmark(1000);
+        hashmap_benchmark(100000);
+        hashmap_benchmark(10000000);
+
+        return 0;
+    }
+
+    // int -> long: squares of 0..999
+    struct hashmap *map = hashmap_new(sizeof(int), sizeof(long), NULL, NULL);
+    for (int i = 0; i < 1000; ++i)
+    {
+        long square = (long) i * i;
+        hashmap_insert(map, &i, &square);
+    }
+    int key = 500, absent = 1000;
+    printf("size %zu, %d -> %ld, %d missing: %d\n", hashmap_size(map), key, *(long *) hashmap_find(map, &key), absent, hashmap_find(map, &absent) == NULL);
+
+    // Erase the even keys, iterate over what is left
+    for (int i = 0; i < 1000; i += 2)
+    {
+        hashmap_erase(map, &i);
+    }
+    printf("after erase: size %zu, %d present: %d, load factor %.2lf\n", hashmap_size(map), key, hashmap_contains(map, &key), hashmap_load_factor(map));
+
+    long sum = 0;
+    size_t visited = 0;
+    for (size_t pos = hashmap_begin(map); pos != hashmap_end(map); pos = hashmap_next(map, pos))
+    {
+        sum += *(long *) hashmap_value(map, pos);
+        ++visited;
+    }
+    printf("iterated %zu keys, sum of squares %ld\n", visited, sum);
+    map = hashmap_delete(map);
+
+    // String keys with user callbacks: count words in place
+    map = hashmap_new(sizeof(char const *), sizeof(int), hashmap_hash_string, hashmap_cmp_string);
+    const char *words[] = {"apple", "banana", "apple", "cherry", "banana", "apple"};
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i)
+    {
+        int inserted = 0;
+        int *count = (int *) hashmap_emplace(map, &words[i], &inserted);
+        *count = inserted ? 1 : *count + 1;
+    }
+    const char *apple = "apple", *banana = "banana", *cherry = "cherry";
+    int apples = 0, bananas = 0, cherries = 0;
+    hashmap_get(map, &apple, &apples);
+    hashmap_get(map, &banana, &bananas);
+    hashmap_get(map, &cherry, &cherries);
+    printf("words: apple %d, banana %d, cherry %d\n", apples, bananas, cherries);
+    map = hashmap_delete(map);
+
+    return 0;
+}
+
+#endif // DATA_STRUCTURES_NO_MAIN
+
+/**
+ * @brief   hashmap_find / hashmap_get / hashmap_contains - O(1) expected: one SSE2 compare per probed group of 16 slots,
+ *              a key comparison only for slots whose 7 hash bits match (1/128 false positives),
+ *          hashmap_insert / hashmap_emplace - O(1) amortized (the table doubles when the load factor is exceeded),
+ *          hashmap_erase - O(1), leaves a tombstone only in groups that have been full,
+ *          hashmap_reserve / hashmap_rehash / hashmap_set_max_load_factor - O(capacity),
+ *          hashmap_clear - O(capacity) (one memset of the control bytes),
+ *          iteration - O(capacity / 16 + size) (free slots are skipped a group at a time).
+ *
+ */
@@ -9,8 +9,18 @@
  */
 
 #include <assert.h> // for assert
+#include <stddef.h> // for size_t && max_align_t
 #include <stdio.h>  // for printf
-#include <stdlib.h> // for calloc && free
+#include <stdlib.h> // for calloc && malloc && free
+#include <string.h> // for memset && strcmp
+
+#include <chrono>   // for std::chrono (benchmark)
+
+#include "../Common/allocator.h"    // for struct ds_allocator (pluggable pool chunks)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>  // for SSE2 && AVX2 intrinsics (unrolled list search)
+#endif
 
 struct list
 {
@@ -46,25 +56,30 @@ struct list *list_delete(struct list *head)
     return NULL;
 }
 
-struct list *list_insert(struct list *head, int elem)
+static struct list *list_append_node(struct list *head, struct list *node)
 {
-    // If there is no head => create new list with one node with value `elem`
+    // If there is no head => `node` is the whole list
     if (!head)
     {
-        return list_new(elem);
+        return node;
     }
     
-    // Insertion (find last element of an list with head `head` and paste new list node in list with head `head`)
+    // Insertion (find last element of an list with head `head` and paste `node` in list with head `head`)
     struct list *listHead = head;
     while (head->next_node)
     {
         head = head->next_node;
     }
-    head->next_node = list_new(elem);
+    head->next_node = node;
 
     return listHead;
 }
 
+struct list *list_insert(struct list *head, int elem)
+{
+    return list_append_node(head, list_new(elem));
+}
+
 struct list *list_find(struct list *head, int elem)
 {
     if (head)
@@ -85,8 +100,10 @@ struct list *list_find(struct list *head, int elem)
     return NULL;
 }
 
-struct list *list_erase(struct list *head, int elem)
+static struct list *list_unlink(struct list *head, int elem, struct list **erased)
 {
+    *erased = NULL;
+
     // Basic cases
     if (!head)
     {
@@ -94,23 +111,21 @@ struct list *list_erase(struct list *head, int elem)
     }
     else if (head->data == elem)
     {
-        struct list *newHead = head->next_node;
-        free(head);
+        *erased = head;
 
-        return newHead;
+        return head->next_node;
     }
 
     // Save list head
     struct list *listHead = head;
 
-    // Erasing
+    // Unlinking
     while (head->next_node)
     {
         if (head->next_node->data == elem)
         {
-            struct list *nodeToErase = head->next_node;
+            *erased = head->next_node;
             head->next_node = head->next_node->next_node;
-            free(nodeToErase);
 
             return listHead;
         }
@@ -120,6 +135,15 @@ struct list *list_erase(struct list *head, int elem)
     return listHead;
 }
 
+struct list *list_erase(struct list *head, int elem)
+{
+    struct list *nodeToErase = NULL;
+    head = list_unlink(head, elem, &nodeToErase);
+    free(nodeToErase);
+
+    return head;
+}
+
 struct list *list_insert_after(struct list *head, struct list *where, struct list *what)
 {
     // Basic cases
@@ -204,29 +228,1212 @@ void list_print(struct list const *head)
     return;
 }
 
-int main()
+//------------------------------------------------------NODE POOL-----------------------------------------------------
+
+/**
+ * @brief Slab allocator for list nodes. Nodes are carved from contiguous chunks (each chunk twice as big as the
+ *        previous one, up to LIST_POOL_MAX_CHUNK_NODES), erased nodes are recycled through an intrusive free list,
+ *        and list_pool_delete releases every node of every list built on the pool in O(chunks).
+ *        Nodes of a pool must not be passed to list_delete/list_erase, which `free` them one by one.
+ *        Chunks come from the allocator given to list_pool_new_alloc (malloc by default).
+ */
+struct list_pool
 {
-    struct list *head = list_new(0);
-    head = list_insert(head, 1);
-    head = list_insert(head, 2);
-    head = list_insert(head, 35);
-    head = list_insert(head, 4);
-    list_print(head);
+    size_t node_size;           // bytes per node, rounded up to max_align_t
+    size_t chunk_nodes;         // number of nodes in the next chunk
 
-    printf("Before erasing: %d\n", list_find(head, 35)->data);
-    list_erase(head, 35);
-    printf("After erasing: %d\n", list_find(head, 4)->data);
+    char *chunks;               // newest chunk; every chunk starts with a pointer to the previous one && its size
+    char *bump;                 // first never used node of the newest chunk
+    char *bump_end;             // end of the newest chunk
 
-    list_insert_after(head, list_new(4), list_new(5));
-    list_print(head);
-    printf("After inserting after: %d\n", list_find(head, 5)->data);
+    void *free_nodes;           // released nodes, linked through their first bytes
 
+    struct ds_allocator allocator;
+};
+
+static const size_t LIST_POOL_CHUNK_HEADER      = (sizeof(char *) + sizeof(size_t) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+static const size_t LIST_POOL_MIN_CHUNK_NODES   = 64;
+static const size_t LIST_POOL_MAX_CHUNK_NODES   = 64 * 1024;
+
+/**
+ * @brief Pool whose chunks are allocated with `allocator` (copied into the pool, its context must outlive it).
+ */
+struct list_pool *list_pool_new_alloc(size_t node_size, struct ds_allocator const *allocator)
+{
+    // Error check
+    assert(node_size >= sizeof(void *) && "pool node must be able to hold a free list pointer!");
+    assert(allocator != NULL);
+
+    // Construction of `list_pool` structure
+    struct list_pool *pool = (struct list_pool *) calloc(1, sizeof(struct list_pool));
+    assert(pool != NULL);
+
+    pool->node_size     = (node_size + alignof(max_align_t) - 1) / alignof(max_align_t) * alignof(max_align_t);
+    pool->chunk_nodes   = LIST_POOL_MIN_CHUNK_NODES;
+    pool->allocator     = *allocator;
+
+    return pool;
+}
+
+struct list_pool *list_pool_new(size_t node_size)
+{
+    return list_pool_new_alloc(node_size, &DS_DEFAULT_ALLOCATOR);
+}
+
+struct list_pool *list_pool_delete(struct list_pool *pool)
+{
+    // Error check
+    assert(pool != NULL);
+
+    // Release chunks (nodes themselves are never freed one by one)
+    while (pool->chunks)
+    {
+        char *prev_chunk = *(char **) pool->chunks;
+        ds_deallocate(&pool->allocator, pool->chunks, *(size_t *) (pool->chunks + sizeof(char *)));
+
+        pool->chunks = prev_chunk;
+    }
+    free(pool);
+
+    return NULL;
+}
+
+void *list_pool_alloc(struct list_pool *pool)
+{
+    // Error check
+    assert(pool != NULL);
+
+    // Recycle an erased node first
+    if (pool->free_nodes)
+    {
+        void *node = pool->free_nodes;
+        pool->free_nodes = *(void **) node;
+
+        return node;
+    }
+
+    // Carve a new chunk when the newest one is used up
+    if (pool->bump == pool->bump_end)
+    {
+        size_t bytes = LIST_POOL_CHUNK_HEADER + pool->chunk_nodes * pool->node_size;
+        char *chunk = (char *) ds_allocate(&pool->allocator, bytes);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+
+        *(char **) chunk = pool->chunks;
+        *(size_t *) (chunk + sizeof(char *)) = bytes;
+        pool->chunks     = chunk;
+        pool->bump       = chunk + LIST_POOL_CHUNK_HEADER;
+        pool->bump_end   = pool->bump + pool->chunk_nodes * pool->node_size;
+
+        if (pool->chunk_nodes < LIST_POOL_MAX_CHUNK_NODES)
+        {
+            pool->chunk_nodes *= 2;
+        }
+    }
+
+    void *node = pool->bump;
+    pool->bump += pool->node_size;
+
+    return node;
+}
+
+void list_pool_free(struct list_pool *pool, void *node)
+{
+    // Error check
+    assert(pool != NULL);
+
+    if (node == NULL)
+    {
+        return;
+    }
+
+    // Push the node on the free list
+    *(void **) node = pool->free_nodes;
+    pool->free_nodes = node;
+}
+
+struct list *list_pool_node(struct list_pool *pool, int elem)
+{
+    // Construction of pooled `list` node
+    struct list *l = (struct list *) list_pool_alloc(pool);
+    assert(l != NULL);
+
+    // Fill `list` fields
+    l->data = elem;
+    l->next_node = NULL;
+
+    return l;
+}
+
+struct list *list_pool_insert(struct list_pool *pool, struct list *head, int elem)
+{
+    return list_append_node(head, list_pool_node(pool, elem));
+}
+
+struct list *list_pool_erase(struct list_pool *pool, struct list *head, int elem)
+{
+    struct list *nodeToErase = NULL;
+    head = list_unlink(head, elem, &nodeToErase);
+    list_pool_free(pool, nodeToErase);
+
+    return head;
+}
+
+//-----------------------------------------------------LIST HANDLE----------------------------------------------------
+
+/**
+ * @brief List object that tracks head, tail and length, so appends are O(1). Nodes are ordinary `struct list`
+ *        nodes (so list_find/list_next/list_print work on `head`) taken from `pool`, or calloc'd when `pool` is NULL.
+ */
+struct list_handle
+{
+    struct list *head;
+    struct list *tail;
+    size_t length;
+
+    struct list_pool *pool;
+};
+
+static struct list *list_handle_node(struct list_handle *h, int elem)
+{
+    return h->pool ? list_pool_node(h->pool, elem) : list_new(elem);
+}
+
+static void list_handle_free_node(struct list_handle *h, struct list *node)
+{
+    if (h->pool)
+    {
+        list_pool_free(h->pool, node);
+    }
+    else
+    {
+        free(node);
+    }
+}
+
+struct list_handle *list_handle_new(struct list_pool *pool)
+{
+    // Construction of `list_handle` structure
+    struct list_handle *h = (struct list_handle *) calloc(1, sizeof(struct list_handle));
+    assert(h != NULL);
+
+    // Fill `list_handle` fields
+    h->head     = NULL;
+    h->tail     = NULL;
+    h->length   = 0;
+    h->pool     = pool;
+
+    return h;
+}
+
+struct list_handle *list_handle_delete(struct list_handle *h)
+{
+    // Error check
+    assert(h != NULL);
+
+    // Deallocate (or give back to the pool) every node
+    while (h->head)
+    {
+        struct list *next_node = h->head->next_node;
+        list_handle_free_node(h, h->head);
+
+        h->head = next_node;
+    }
+    free(h);
+
+    return NULL;
+}
+
+int list_handle_push_back(struct list_handle *h, int elem)
+{
+    // Error check
+    assert(h != NULL);
+
+    struct list *node = list_handle_node(h, elem);
+    if (node == NULL)
+    {
+        return 1;
+    }
+
+    // Append right after the tail
+    if (h->tail)
+    {
+        h->tail->next_node = node;
+    }
+    else
+    {
+        h->head = node;
+    }
+    h->tail = node;
+    ++h->length;
+
+    return 0;
+}
+
+int list_handle_push_front(struct list_handle *h, int elem)
+{
+    // Error check
+    assert(h != NULL);
+
+    struct list *node = list_handle_node(h, elem);
+    if (node == NULL)
+    {
+        return 1;
+    }
+
+    // Prepend before the head
+    node->next_node = h->head;
+    h->head = node;
+    if (!h->tail)
+    {
+        h->tail = node;
+    }
+    ++h->length;
+
+    return 0;
+}
+
+struct list *list_handle_find(struct list_handle const *h, int elem)
+{
+    return list_find(h->head, elem);
+}
+
+int list_handle_erase(struct list_handle *h, int elem)
+{
+    // Error check
+    assert(h != NULL);
+
+    // Find the node && its predecessor in one pass
+    struct list *prev = NULL;
+    struct list *curr = h->head;
+    while (curr && curr->data != elem)
+    {
+        prev = curr;
+        curr = curr->next_node;
+    }
+
+    if (!curr)
+    {
+        return 1;
+    }
+
+    // Unlink it (keeping the tail up to date)
+    if (prev)
+    {
+        prev->next_node = curr->next_node;
+    }
+    else
+    {
+        h->head = curr->next_node;
+    }
+    if (h->tail == curr)
+    {
+        h->tail = prev;
+    }
+    list_handle_free_node(h, curr);
+    --h->length;
+
+    return 0;
+}
+
+int list_handle_insert_after(struct list_handle *h, struct list *where, struct list *what)
+{
+    // Error check
+    assert(h != NULL);
+
+    if (where == NULL || what == NULL)
+    {
+        return 1;
+    }
+
+    // `where` is a node of this list, so no search is needed
+    what->next_node = where->next_node;
+    where->next_node = what;
+    if (h->tail == where)
+    {
+        h->tail = what;
+    }
+    ++h->length;
 
-    head = list_delete(head);
-    
     return 0;
 }
 
+int list_handle_insert_before(struct list_handle *h, struct list *where, struct list *what)
+{
+    // Error check
+    assert(h != NULL);
+
+    if (where == NULL || what == NULL)
+    {
+        return 1;
+    }
+
+    // Inserting before the head
+    if (h->head == where)
+    {
+        what->next_node = where;
+        h->head = what;
+        ++h->length;
+
+        return 0;
+    }
+
+    // Inserting before element (a single scan for the predecessor)
+    for (struct list *prev = h->head; prev; prev = prev->next_node)
+    {
+        if (prev->next_node == where)
+        {
+            prev->next_node = what;
+            what->next_node = where;
+            ++h->length;
+
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+size_t list_handle_size(struct list_handle const *h)
+{
+    return h->length;
+}
+
+void list_handle_print(struct list_handle const *h)
+{
+    list_print(h->head);
+}
+
+//----------------------------------------------------GENERIC LIST----------------------------------------------------
+
+/**
+ * @brief List with an arbitrary payload of `elem_size` bytes per element (like the other containers). The payload
+ *        is stored inline right after the `next_node` pointer, in the same pooled allocation as the node, so
+ *        reaching an element costs no extra indirection. Elements are compared with a user comparator that
+ *        returns 0 for equal elements (memcmp-like).
+ */
+struct glist_node
+{
+    struct glist_node *next_node;
+};
+
+struct glist
+{
+    struct glist_node *head;
+    struct glist_node *tail;
+    size_t length;
+
+    size_t elem_size;
+    size_t payload_offset;      // offset of the payload from the node start
+
+    struct list_pool *pool;     // owns every node of the list
+};
+
+typedef int (*glist_cmp)(void const *elem, void const *key);
+
+/**
+ * @brief Generic list whose nodes come from a pool on `allocator` (its context must outlive the list).
+ */
+struct glist *glist_new_alloc(size_t elem_size, struct ds_allocator const *allocator)
+{
+    // Error check
+    assert(elem_size > 0 && "new list elem size must be greater than zero!");
+
+    // Construction of `glist` structure
+    struct glist *l = (struct glist *) calloc(1, sizeof(struct glist));
+    assert(l != NULL);
+
+    // Payload alignment: largest power of two that divides elem_size (up to max_align_t)
+    size_t align = 1;
+    while (align < alignof(max_align_t) && elem_size % (2 * align) == 0)
+    {
+        align *= 2;
+    }
+
+    // Fill `glist` fields
+    l->head             = NULL;
+    l->tail             = NULL;
+    l->length           = 0;
+    l->elem_size        = elem_size;
+    l->payload_offset   = (sizeof(struct glist_node) + align - 1) / align * align;
+    l->pool             = list_pool_new_alloc(l->payload_offset + elem_size, allocator);
+
+    return l;
+}
+
+struct glist *glist_new(size_t elem_size)
+{
+    return glist_new_alloc(elem_size, &DS_DEFAULT_ALLOCATOR);
+}
+
+struct glist *glist_delete(struct glist *l)
+{
+    // Error check
+    assert(l != NULL);
+
+    // Every node lives in the pool
+    l->pool = list_pool_delete(l->pool);
+    free(l);
+
+    return NULL;
+}
+
+void *glist_data(struct glist const *l, struct glist_node *node)
+{
+    return node ? (char *) node + l->payload_offset : NULL;
+}
+
+struct glist_node *glist_next(struct glist_node *curr)
+{
+    return curr ? curr->next_node : NULL;
+}
+
+static struct glist_node *glist_node_new(struct glist *l, void const *elem)
+{
+    struct glist_node *node = (struct glist_node *) list_pool_alloc(l->pool);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+
+    node->next_node = NULL;
+    memcpy(glist_data(l, node), elem, l->elem_size);
+
+    return node;
+}
+
+int glist_push_back(struct glist *l, void const *elem)
+{
+    // Error check
+    assert(l != NULL && elem != NULL);
+
+    struct glist_node *node = glist_node_new(l, elem);
+    if (node == NULL)
+    {
+        return 1;
+    }
+
+    // Append right after the tail
+    if (l->tail)
+    {
+        l->tail->next_node = node;
+    }
+    else
+    {
+        l->head = node;
+    }
+    l->tail = node;
+    ++l->length;
+
+    return 0;
+}
+
+int glist_push_front(struct glist *l, void const *elem)
+{
+    // Error check
+    assert(l != NULL && elem != NULL);
+
+    struct glist_node *node = glist_node_new(l, elem);
+    if (node == NULL)
+    {
+        return 1;
+    }
+
+    // Prepend before the head
+    node->next_node = l->head;
+    l->head = node;
+    if (!l->tail)
+    {
+        l->tail = node;
+    }
+    ++l->length;
+
+    return 0;
+}
+
+struct glist_node *glist_find(struct glist const *l, void const *key, glist_cmp cmp)
+{
+    // Error check
+    assert(l != NULL && key != NULL && cmp != NULL);
+
+    for (struct glist_node *node = l->head; node; node = node->next_node)
+    {
+        if (cmp((char *) node + l->payload_offset, key) == 0)
+        {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+int glist_erase(struct glist *l, void const *key, glist_cmp cmp)
+{
+    // Error check
+    assert(l != NULL && key != NULL && cmp != NULL);
+
+    // Find the node && its predecessor in one pass
+    struct glist_node *prev = NULL;
+    struct glist_node *curr = l->head;
+    while (curr && cmp((char *) curr + l->payload_offset, key) != 0)
+    {
+        prev = curr;
+        curr = curr->next_node;
+    }
+
+    if (!curr)
+    {
+        return 1;
+    }
+
+    // Unlink it (keeping the tail up to date) && recycle the node
+    if (prev)
+    {
+        prev->next_node = curr->next_node;
+    }
+    else
+    {
+        l->head = curr->next_node;
+    }
+    if (l->tail == curr)
+    {
+        l->tail = prev;
+    }
+    list_pool_free(l->pool, curr);
+    --l->length;
+
+    return 0;
+}
+
+size_t glist_size(struct glist const *l)
+{
+    return l->length;
+}
+
+void glist_print(struct glist const *l, void (*pf)(void const *data))
+{
+    // Error check
+    assert(l != NULL && pf != NULL);
+
+    // Printing
+    putchar('[');
+    for (struct glist_node *node = l->head; node; node = node->next_node)
+    {
+        pf((char *) node + l->payload_offset);
+        if (node->next_node)
+        {
+            printf(", ");
+        }
+    }
+    printf("]\n");
+
+    return;
+}
+
+//---------------------------------------------------UNROLLED LIST----------------------------------------------------
+
+/**
+ * @brief Unrolled list of ints: every node holds a small array of elements and is exactly two cache lines big,
+ *        so a scan touches one `next_node` pointer per ULIST_NODE_CAPACITY elements instead of one per element.
+ *        A full node is split in halves on insertion; a node that falls below half full on erase borrows from
+ *        or merges with its successor. Positions are (node, index) pairs, see `struct ulist_iter`.
+ */
+static const size_t ULIST_NODE_SIZE     = 128;
+static const int    ULIST_NODE_CAPACITY = (int) ((ULIST_NODE_SIZE - sizeof(void *) - sizeof(int)) / sizeof(int));
+
+struct ulist_node
+{
+    struct ulist_node *next_node;
+    int count;
+    int elems[ULIST_NODE_CAPACITY];
+};
+
+struct ulist
+{
+    struct ulist_node *head;
+    struct ulist_node *tail;
+    size_t length;
+
+    struct list_pool *pool;     // owns every node of the list
+};
+
+struct ulist_iter
+{
+    struct ulist_node *node;    // NULL for "no element"
+    int idx;
+};
+
+/**
+ * @brief Unrolled list whose nodes come from a pool on `allocator` (its context must outlive the list).
+ */
+struct ulist *ulist_new_alloc(struct ds_allocator const *allocator)
+{
+    // Construction of `ulist` structure
+    struct ulist *l = (struct ulist *) calloc(1, sizeof(struct ulist));
+    assert(l != NULL);
+
+    // Fill `ulist` fields
+    l->head     = NULL;
+    l->tail     = NULL;
+    l->length   = 0;
+    l->pool     = list_pool_new_alloc(sizeof(struct ulist_node), allocator);
+
+    return l;
+}
+
+struct ulist *ulist_new()
+{
+    return ulist_new_alloc(&DS_DEFAULT_ALLOCATOR);
+}
+
+struct ulist *ulist_delete(struct ulist *l)
+{
+    // Error check
+    assert(l != NULL);
+
+    // Every node lives in the pool
+    l->pool = list_pool_delete(l->pool);
+    free(l);
+
+    return NULL;
+}
+
+static struct ulist_node *ulist_node_new(struct ulist *l)
+{
+    struct ulist_node *node = (struct ulist_node *) list_pool_alloc(l->pool);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+
+    node->next_node = NULL;
+    node->count     = 0;
+
+    return node;
+}
+
+static struct ulist_node *ulist_split(struct ulist *l, struct ulist_node *node)
+{
+    // Move the upper half of `node` into a new node right after it
+    struct ulist_node *upper = ulist_node_new(l);
+    if (upper == NULL)
+    {
+        return NULL;
+    }
+
+    int half = node->count / 2;
+    upper->count = node->count - half;
+    memcpy(upper->elems, &node->elems[half], upper->count * sizeof(int));
+    node->count = half;
+
+    upper->next_node = node->next_node;
+    node->next_node = upper;
+    if (l->tail == node)
+    {
+        l->tail = upper;
+    }
+
+    return upper;
+}
+
+int ulist_insert(struct ulist *l, int elem)
+{
+    // Error check
+    assert(l != NULL);
+
+    // Open a new tail node when the current one is full
+    if (!l->tail || l->tail->count == ULIST_NODE_CAPACITY)
+    {
+        struct ulist_node *node = ulist_node_new(l);
+        if (node == NULL)
+        {
+            return 1;
+        }
+
+        if (l->tail)
+        {
+            l->tail->next_node = node;
+        }
+        else
+        {
+            l->head = node;
+        }
+        l->tail = node;
+    }
+
+    // Append
+    l->tail->elems[l->tail->count++] = elem;
+    ++l->length;
+
+    return 0;
+}
+
+int ulist_insert_after(struct ulist *l, struct ulist_iter where, int elem)
+{
+    // Error check
+    assert(l != NULL);
+
+    if (where.node == NULL || where.idx < 0 || where.idx >= where.node->count)
+    {
+        return 1;
+    }
+
+    struct ulist_node *node = where.node;
+    int pos = where.idx + 1;
+
+    // Split a full node && continue in the half that holds the insertion position
+    if (node->count == ULIST_NODE_CAPACITY)
+    {
+        struct ulist_node *upper = ulist_split(l, node);
+        if (upper == NULL)
+        {
+            return 1;
+        }
+
+        if (pos > node->count)
+        {
+            pos -= node->count;
+            node = upper;
+        }
+    }
+
+    // Shift the rest of the node && insert
+    memmove(&node->elems[pos + 1], &node->elems[pos], (node->count - pos) * sizeof(int));
+    node->elems[pos] = elem;
+    ++node->count;
+    ++l->length;
+
+    return 0;
+}
+
+/**
+ * Search inside one node: the elements of a node are contiguous, so they are compared 8 (AVX2) or 4 (SSE2) at a
+ * time. The AVX2 version is picked at run time (checked once); every version returns -1 when `elem` is absent.
+ */
+static int ulist_node_find_scalar(int const *elems, int count, int elem)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (elems[i] == elem)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define ULIST_SIMD_X86 1
+
+__attribute__((target("avx2"))) static int ulist_node_find_avx2(int const *elems, int count, int elem)
+{
+    __m256i keys = _mm256_set1_epi32(elem);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i block = _mm256_loadu_si256((__m256i const *) &elems[i]);
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, keys)));
+        if (mask)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    int tail = ulist_node_find_scalar(&elems[i], count - i, elem);
+    return tail < 0 ? -1 : i + tail;
+}
+
+static int ulist_node_find_sse2(int const *elems, int count, int elem)
+{
+    __m128i keys = _mm_set1_epi32(elem);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i block = _mm_loadu_si128((__m128i const *) &elems[i]);
+        unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, keys)));
+        if (mask)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    int tail = ulist_node_find_scalar(&elems[i], count - i, elem);
+    return tail < 0 ? -1 : i + tail;
+}
+#endif
+
+static int ulist_node_find(struct ulist_node const *node, int elem)
+{
+#ifdef ULIST_SIMD_X86
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2 ? ulist_node_find_avx2(node->elems, node->count, elem) :
+                      ulist_node_find_sse2(node->elems, node->count, elem);
+#else
+    return ulist_node_find_scalar(node->elems, node->count, elem);
+#endif
+}
+
+struct ulist_iter ulist_find(struct ulist const *l, int elem)
+{
+    // Error check
+    assert(l != NULL);
+
+    for (struct ulist_node *node = l->head; node; node = node->next_node)
+    {
+        int idx = ulist_node_find(node, elem);
+        if (idx >= 0)
+        {
+            return {node, idx};
+        }
+    }
+
+    return {NULL, 0};
+}
+
+int ulist_erase(struct ulist *l, int elem)
+{
+    // Error check
+    assert(l != NULL);
+
+    // Find the node holding `elem` && its predecessor
+    struct ulist_node *prev = NULL;
+    struct ulist_node *node = l->head;
+    int idx = -1;
+    while (node)
+    {
+        idx = ulist_node_find(node, elem);
+        if (idx >= 0)
+        {
+            break;
+        }
+
+        prev = node;
+        node = node->next_node;
+    }
+
+    if (!node)
+    {
+        return 1;
+    }
+
+    // Erase the element inside the node
+    memmove(&node->elems[idx], &node->elems[idx + 1], (node->count - idx - 1) * sizeof(int));
+    --node->count;
+    --l->length;
+
+    // Rebalance an underfull node with its successor: merge when both fit in one node, borrow otherwise
+    struct ulist_node *next = node->next_node;
+    if (node->count < ULIST_NODE_CAPACITY / 2 && next)
+    {
+        if (node->count + next->count <= ULIST_NODE_CAPACITY)
+        {
+            memcpy(&node->elems[node->count], next->elems, next->count * sizeof(int));
+            node->count += next->count;
+
+            node->next_node = next->next_node;
+            if (l->tail == next)
+            {
+                l->tail = node;
+            }
+            list_pool_free(l->pool, next);
+        }
+        else
+        {
+            int moved = (next->count - node->count) / 2;
+            memcpy(&node->elems[node->count], next->elems, moved * sizeof(int));
+            memmove(next->elems, &next->elems[moved], (next->count - moved) * sizeof(int));
+            node->count += moved;
+            next->count -= moved;
+        }
+    }
+
+    // Unlink a node that became empty (only the last node can get here without a successor)
+    if (node->count == 0)
+    {
+        if (prev)
+        {
+            prev->next_node = node->next_node;
+        }
+        else
+        {
+            l->head = node->next_node;
+        }
+        if (l->tail == node)
+        {
+            l->tail = prev;
+        }
+        list_pool_free(l->pool, node);
+    }
+
+    return 0;
+}
+
+struct ulist_iter ulist_begin(struct ulist const *l)
+{
+    return {l->head, 0};
+}
+
+struct ulist_iter ulist_next(struct ulist_iter curr)
+{
+    // Basic check
+    if (!curr.node)
+    {
+        return curr;
+    }
+
+    // Next element of the same node, or the first one of the next node
+    if (curr.idx + 1 < curr.node->count)
+    {
+        return {curr.node, curr.idx + 1};
+    }
+
+    return {curr.node->next_node, 0};
+}
+
+int *ulist_get(struct ulist_iter curr)
+{
+    return curr.node ? &curr.node->elems[curr.idx] : NULL;
+}
+
+size_t ulist_size(struct ulist const *l)
+{
+    return l->length;
+}
+
+void ulist_print(struct ulist const *l)
+{
+    putchar('[');
+    for (struct ulist_iter it = ulist_begin(l); it.node; )
+    {
+        printf("%d", *ulist_get(it));
+
+        it = ulist_next(it);
+        if (it.node)
+        {
+            printf(", ");
+        }
+    }
+    printf("]\n");
+
+    return;
+}
+
+//------------------------------------------------------TESTING-------------------------------------------------------
+
+// Define DATA_STRUCTURES_NO_MAIN to include this file into another program (see Benchmark/main.cpp)
+#ifndef DATA_STRUCTURES_NO_MAIN
+
+struct point
+{
+    double x;
+    double y;
+};
+
+static int point_cmp(void const *elem, void const *key)
+{
+    return memcmp(elem, key, sizeof(struct point));
+}
+
+static void print_point(void const *data)
+{
+    printf("(%g, %g)", ((struct point const *) data)->x, ((struct point const *) data)->y);
+}
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Build a list of `n` nodes (by prepending), scan it with list_find and tear it down; calloc'd nodes vs pooled nodes
+static void list_benchmark(size_t n)
+{
+    // calloc'd nodes
+    auto start = std::chrono::steady_clock::now();
+    struct list *head = NULL;
+    for (size_t i = 0; i < n; ++i)
+    {
+        struct list *node = list_new((int) i);
+        node->next_node = head;
+        head = node;
+    }
+    double heap_build = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    struct list *heap_found = list_find(head, -1);
+    double heap_find = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    head = list_delete(head);
+    double heap_delete = elapsed_ns(start);
+
+    // pooled nodes
+    start = std::chrono::steady_clock::now();
+    struct list_pool *pool = list_pool_new(sizeof(struct list));
+    for (size_t i = 0; i < n; ++i)
+    {
+        struct list *node = list_pool_node(pool, (int) i);
+        node->next_node = head;
+        head = node;
+    }
+    double pool_build = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    struct list *pool_found = list_find(head, -1);
+    double pool_find = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    pool = list_pool_delete(pool);
+    double pool_delete = elapsed_ns(start);
+
+    printf("%zu nodes%s\n", n, (heap_found || pool_found) ? " (unexpected find)" : "");
+    printf("    build:  calloc %6.2lf ns/node, pool %6.2lf ns/node\n", heap_build / n, pool_build / n);
+    printf("    find:   calloc %6.2lf ns/node, pool %6.2lf ns/node\n", heap_find / n, pool_find / n);
+    printf("    delete: calloc %6.2lf ns/node, pool %6.2lf ns/node\n", heap_delete / n, pool_delete / n);
+}
+
+// Scan `n` elements with find in a node-per-element list (pooled) and in an unrolled list, and scan the unrolled
+// list's nodes both with the scalar loop and with the SIMD search
+static void ulist_benchmark(size_t n)
+{
+    struct list_pool *pool = list_pool_new(sizeof(struct list));
+    struct list *head = NULL;
+    for (size_t i = 0; i < n; ++i)
+    {
+        struct list *node = list_pool_node(pool, (int) i);
+        node->next_node = head;
+        head = node;
+    }
+
+    struct ulist *ul = ulist_new();
+    for (size_t i = 0; i < n; ++i)
+    {
+        ulist_insert(ul, (int) (n - 1 - i));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    struct list *list_found = list_find(head, -1);
+    double list_find_ns = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    struct ulist_iter ulist_found = ulist_find(ul, -1);
+    double ulist_find_ns = elapsed_ns(start);
+
+    // Same unrolled list traversal, but every node is scanned one element at a time
+    start = std::chrono::steady_clock::now();
+    int scalar_found = -1;
+    for (struct ulist_node *node = ul->head; node && scalar_found < 0; node = node->next_node)
+    {
+        scalar_found = ulist_node_find_scalar(node->elems, node->count, -1);
+    }
+    double scalar_find_ns = elapsed_ns(start);
+
+    printf("%zu elements%s\n", n, (list_found || ulist_found.node || scalar_found >= 0) ? " (unexpected find)" : "");
+    printf("    find:   list %6.2lf ns/elem, unrolled list %6.2lf ns/elem\n", list_find_ns / n, ulist_find_ns / n);
+    printf("    node scan: scalar %6.2lf ns/elem, SIMD %6.2lf ns/elem\n", scalar_find_ns / n, ulist_find_ns / n);
+
+    pool = list_pool_delete(pool);
+    ul = ulist_delete(ul);
+}
+
+// Run with `--bench` to compare calloc'd and pooled nodes, node-per-element and unrolled traversal, and the scalar
+// and SIMD node scans
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        list_benchmark(1000000);
+        list_benchmark(10000000);
+        ulist_benchmark(1000000);
+        ulist_benchmark(10000000);
+
+        return 0;
+    }
+
+    struct list *head = list_new(0);
+    head = list_insert(head, 1);
+    head = list_insert(head, 2);
+    head = list_insert(head, 35);
+    head = list_insert(head, 4);
+    list_print(head);
+
+    printf("Before erasing: %d\n", list_find(head, 35)->data);
+    list_erase(head, 35);
+    printf("After erasing: %d\n", list_find(head, 4)->data);
+
+    list_insert_after(head, list_new(4), list_new(5));
+    list_print(head);
+    printf("After inserting after: %d\n", list_find(head, 5)->data);
+
+
+    head = list_delete(head);
+
+    // Same list on a node pool: erased nodes are recycled, the whole list goes away with the pool
+    struct list_pool *pool = list_pool_new(sizeof(struct list));
+    head = NULL;
+    for (int i = 0; i < 5; ++i)
+    {
+        head = list_pool_insert(pool, head, i);
+    }
+    head = list_pool_erase(pool, head, 0);
+    head = list_pool_insert(pool, head, 42);
+    list_print(head);
+
+    // List handle on the same pool: O(1) appends && insertion after a known node
+    struct list_handle *h = list_handle_new(pool);
+    for (int i = 0; i < 5; ++i)
+    {
+        list_handle_push_back(h, i);
+    }
+    list_handle_push_front(h, -1);
+    list_handle_erase(h, 4);
+    list_handle_insert_after(h, h->tail, list_pool_node(pool, 10));
+    list_handle_insert_before(h, list_handle_find(h, 2), list_pool_node(pool, 20));
+    list_handle_print(h);
+    printf("length: %zu, tail: %d\n", list_handle_size(h), h->tail->data);
+    h = list_handle_delete(h);
+
+    pool = list_pool_delete(pool);
+
+    // Generic list of 16-byte structs: payload sits inline in the node
+    struct glist *gl = glist_new(sizeof(struct point));
+    for (int i = 0; i < 4; ++i)
+    {
+        struct point pt = {(double) i, (double) i * i};
+        glist_push_back(gl, &pt);
+    }
+    struct point key = {2, 4};
+    printf("found: %d\n", glist_find(gl, &key, point_cmp) != NULL);
+    glist_erase(gl, &key, point_cmp);
+    glist_print(gl, print_point);
+    gl = glist_delete(gl);
+
+    // Unrolled list: 29 ints per 128-byte node, split on insert && merge on erase
+    struct ulist *ul = ulist_new();
+    for (int i = 0; i < 60; ++i)
+    {
+        ulist_insert(ul, i);
+    }
+    ulist_insert_after(ul, ulist_find(ul, 5), 100);
+    for (int i = 10; i < 50; ++i)
+    {
+        ulist_erase(ul, i);
+    }
+    ulist_print(ul);
+    printf("size: %zu, after 100: %d\n", ulist_size(ul), *ulist_get(ulist_next(ulist_find(ul, 100))));
+    ul = ulist_delete(ul);
+    
+    return 0;
+}
+
+#endif // DATA_STRUCTURES_NO_MAIN
+
 /**
  * @brief   list_next           - O(1),
  *          list_insert_before  - O(n),
@@ -234,5 +1441,13 @@ int main()
  *          list_erase          - O(n),
  *          list_find           - O(n),
  *          list_insert         - O(n),
+ *          list_handle_push_back / push_front / insert_after - O(1),
+ *          list_handle_insert_before / erase                  - O(n), a single scan for the predecessor,
+ *          glist_push_back / glist_push_front - O(1), glist_find / glist_erase - O(n) comparator calls,
+ *          ulist_insert        - O(1), ulist_insert_after - O(B) for B = ULIST_NODE_CAPACITY,
+ *          ulist_find / ulist_erase - O(n), but with n / B pointer hops instead of n and SIMD compares inside a node,
+ *          list_pool_alloc     - O(1) (amortized: a new chunk is allocated once per chunk_nodes nodes),
+ *          list_pool_free      - O(1),
+ *          list_pool_delete    - O(number of chunks),
  * 
  */
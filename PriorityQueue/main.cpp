@@ -0,0 +1,702 @@
+/**
+ * @file main.cpp
+ * @author Vladislav Skvortsov
+ * @brief Implementation of priority queue (d-ary heap) data structure with elements of any type support (+ basic interface)
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+// The heap keeps its elements in a `struct vector`; the vector demo must not end up in this program
+#ifdef DATA_STRUCTURES_NO_MAIN
+#include "../Vector/main.cpp"
+#else
+#define DATA_STRUCTURES_NO_MAIN
+#include "../Vector/main.cpp"
+#undef DATA_STRUCTURES_NO_MAIN
+#endif
+
+#include <assert.h> // for assert
+#include <stddef.h> // for size_t
+#include <stdint.h> // for SIZE_MAX && uint64_t
+#include <stdio.h>  // for printf
+#include <stdlib.h> // for calloc && malloc && free
+#include <string.h> // for memcpy && strcmp
+
+#include <chrono>   // for std::chrono (benchmark)
+#include <queue>    // for std::priority_queue (benchmark baseline)
+#include <random>   // for std::mt19937_64 (benchmark)
+#include <vector>   // for std::vector (benchmark baseline storage)
+
+/**
+ * @brief Heap of `elem_size` byte elements ordered by `cmp`: the element with the smallest `cmp` rank is on top
+ *        (cmp(a, b) < 0 means that `a` goes out before `b`, so a qsort-style ascending comparator gives a min-heap).
+ *        Every node has `arity` children; 2 is the classic binary heap, 4 && 8 make the tree 2-3 times shallower
+ *        && put all children of a node next to each other, which saves cache misses on pop at the price of more
+ *        comparisons per level. An indexed heap (pqueue_new_indexed) also hands out a handle per element, so that
+ *        its key can be changed (pqueue_decrease_key, pqueue_update) or it can be removed before reaching the top.
+ */
+struct pqueue
+{
+    struct vector *heap;        // elements in heap order, the top is heap[0]
+    size_t arity;               // children per node (>= 2)
+    int (*cmp)(void const *a, void const *b);
+
+    void *hole;                 // one element of scratch space, holds the element being sifted
+
+    // Indexed heaps only (NULL otherwise)
+    struct vector *slot_handle; // size_t per heap slot: handle of the element there
+    struct vector *handle_slot; // size_t per handle: heap slot of its element, PQUEUE_NO_SLOT if it is gone
+    struct vector *free_handles;// handles of removed elements, reused before new ones are issued
+};
+
+static const size_t PQUEUE_NO_SLOT          = SIZE_MAX;
+static const size_t PQUEUE_DEFAULT_ARITY    = 4;
+
+static inline char *pqueue_slot(struct pqueue *pq, size_t slot)
+{
+    return (char *) vector_data(pq->heap) + slot * pq->heap->elem_size;
+}
+
+static inline size_t *pqueue_slot_handle(struct pqueue *pq)
+{
+    return (size_t *) vector_data(pq->slot_handle);
+}
+
+static inline size_t *pqueue_handle_slot(struct pqueue *pq)
+{
+    return (size_t *) vector_data(pq->handle_slot);
+}
+
+static struct pqueue *pqueue_create(size_t elem_size, size_t arity, int (*cmp)(void const *, void const *), int indexed)
+{
+    // Error check
+    assert(elem_size > 0 && arity >= 2 && cmp != NULL);
+
+    // Construction of `pqueue` structure
+    struct pqueue *pq = (struct pqueue *) calloc(1, sizeof(struct pqueue));
+    assert(pq != NULL);
+
+    pq->heap    = vector_new(0, elem_size);
+    pq->arity   = arity;
+    pq->cmp     = cmp;
+    pq->hole    = malloc(elem_size);
+    assert(pq->hole != NULL);
+
+    if (indexed)
+    {
+        pq->slot_handle     = vector_new(0, sizeof(size_t));
+        pq->handle_slot     = vector_new(0, sizeof(size_t));
+        pq->free_handles    = vector_new(0, sizeof(size_t));
+    }
+
+    return pq;
+}
+
+struct pqueue *pqueue_new(size_t elem_size, size_t arity, int (*cmp)(void const *, void const *))
+{
+    return pqueue_create(elem_size, arity, cmp, 0);
+}
+
+struct pqueue *pqueue_new_indexed(size_t elem_size, size_t arity, int (*cmp)(void const *, void const *))
+{
+    return pqueue_create(elem_size, arity, cmp, 1);
+}
+
+struct pqueue *pqueue_delete(struct pqueue *pq)
+{
+    // Error check
+    assert(pq != NULL);
+
+    // Destruction
+    pq->heap = vector_delete(pq->heap);
+    if (pq->slot_handle != NULL)
+    {
+        pq->slot_handle     = vector_delete(pq->slot_handle);
+        pq->handle_slot     = vector_delete(pq->handle_slot);
+        pq->free_handles    = vector_delete(pq->free_handles);
+    }
+    free(pq->hole);
+    free(pq);
+
+    return NULL;
+}
+
+//------------------------------------------------------SIFTING-------------------------------------------------------
+
+// Move the element (&& its handle) of slot `from` to slot `to`; the sifts below move a hole instead of swapping
+static inline void pqueue_move(struct pqueue *pq, size_t from, size_t to)
+{
+    memcpy(pqueue_slot(pq, to), pqueue_slot(pq, from), pq->heap->elem_size);
+    if (pq->slot_handle != NULL)
+    {
+        size_t handle = pqueue_slot_handle(pq)[from];
+        pqueue_slot_handle(pq)[to]      = handle;
+        pqueue_handle_slot(pq)[handle]  = to;
+    }
+}
+
+// Put `pq->hole` (with handle `handle`) into slot `slot`
+static inline void pqueue_fill(struct pqueue *pq, size_t slot, size_t handle)
+{
+    memcpy(pqueue_slot(pq, slot), pq->hole, pq->heap->elem_size);
+    if (pq->slot_handle != NULL)
+    {
+        pqueue_slot_handle(pq)[slot]    = handle;
+        pqueue_handle_slot(pq)[handle]  = slot;
+    }
+}
+
+// Move the hole at `slot` up while `pq->hole` goes out before the parent, then fill it
+static void pqueue_sift_up(struct pqueue *pq, size_t slot, size_t handle)
+{
+    while (slot > 0)
+    {
+        size_t parent = (slot - 1) / pq->arity;
+        if (pq->cmp(pq->hole, pqueue_slot(pq, parent)) >= 0)
+        {
+            break;
+        }
+        pqueue_move(pq, parent, slot);
+        slot = parent;
+    }
+    pqueue_fill(pq, slot, handle);
+}
+
+// Move the hole at `slot` down while some child goes out before `pq->hole`, then fill it
+static void pqueue_sift_down(struct pqueue *pq, size_t slot, size_t handle)
+{
+    size_t size = vector_size(pq->heap);
+    for (;;)
+    {
+        size_t first = slot * pq->arity + 1;
+        if (first >= size)
+        {
+            break;
+        }
+
+        // Best of the (adjacent) children
+        size_t last = first + pq->arity < size ? first + pq->arity : size;
+        size_t best = first;
+        for (size_t child = first + 1; child < last; ++child)
+        {
+            if (pq->cmp(pqueue_slot(pq, child), pqueue_slot(pq, best)) < 0)
+            {
+                best = child;
+            }
+        }
+
+        if (pq->cmp(pqueue_slot(pq, best), pq->hole) >= 0)
+        {
+            break;
+        }
+        pqueue_move(pq, best, slot);
+        slot = best;
+    }
+    pqueue_fill(pq, slot, handle);
+}
+
+/**
+ * @brief Sift for the removal path: the element filling the gap comes from the bottom of the heap && almost always
+ *        goes back down there, so the hole first walks down to a leaf without comparing with it (d - 1 comparisons
+ *        per level instead of d) && the element then sifts up the last few levels from that leaf.
+ */
+static void pqueue_sift_down_to_leaf(struct pqueue *pq, size_t slot, size_t handle)
+{
+    size_t size = vector_size(pq->heap);
+    for (;;)
+    {
+        size_t first = slot * pq->arity + 1;
+        if (first >= size)
+        {
+            break;
+        }
+
+        size_t last = first + pq->arity < size ? first + pq->arity : size;
+        size_t best = first;
+        for (size_t child = first + 1; child < last; ++child)
+        {
+            if (pq->cmp(pqueue_slot(pq, child), pqueue_slot(pq, best)) < 0)
+            {
+                best = child;
+            }
+        }
+        pqueue_move(pq, best, slot);
+        slot = best;
+    }
+    pqueue_sift_up(pq, slot, handle);
+}
+
+// Issue a handle for an element going to slot `slot`
+static size_t pqueue_new_handle(struct pqueue *pq, size_t slot)
+{
+    size_t handle = 0;
+    if (vector_pop(pq->free_handles, &handle) == 0)
+    {
+        pqueue_handle_slot(pq)[handle] = slot;
+    }
+    else
+    {
+        handle = vector_size(pq->handle_slot);
+        vector_push(pq->handle_slot, &slot);
+    }
+
+    return handle;
+}
+
+// Remove the element of slot `slot` (copied to `elem` unless it is NULL) && close the gap with the last one
+static void pqueue_remove_slot(struct pqueue *pq, size_t slot, void *elem)
+{
+    if (elem != NULL)
+    {
+        memcpy(elem, pqueue_slot(pq, slot), pq->heap->elem_size);
+    }
+
+    size_t last_handle = 0;
+    if (pq->slot_handle != NULL)
+    {
+        size_t handle = pqueue_slot_handle(pq)[slot];
+        pqueue_handle_slot(pq)[handle] = PQUEUE_NO_SLOT;
+        vector_push(pq->free_handles, &handle);
+        vector_pop(pq->slot_handle, &last_handle);
+    }
+    vector_pop(pq->heap, pq->hole);
+
+    // The last element takes the freed slot, it may have to go either way from there
+    if (slot == vector_size(pq->heap))
+    {
+        return;
+    }
+    if (slot > 0 && pq->cmp(pq->hole, pqueue_slot(pq, (slot - 1) / pq->arity)) < 0)
+    {
+        pqueue_sift_up(pq, slot, last_handle);
+    }
+    else
+    {
+        pqueue_sift_down_to_leaf(pq, slot, last_handle);
+    }
+}
+
+//-----------------------------------------------------INTERFACE------------------------------------------------------
+
+// `handle` (may be NULL) receives the handle of the element in an indexed heap
+int pqueue_push_handle(struct pqueue *pq, void const *elem, size_t *handle)
+{
+    // Error check
+    assert(pq != NULL && elem != NULL);
+
+    // Open a slot at the end && sift the new element up from there
+    size_t slot = vector_size(pq->heap);
+    if (vector_emplace_back(pq->heap) == NULL)
+    {
+        return 1;
+    }
+
+    size_t new_handle = 0;
+    if (pq->slot_handle != NULL)
+    {
+        if (vector_emplace_back(pq->slot_handle) == NULL)
+        {
+            vector_resize(pq->heap, slot);
+            return 1;
+        }
+        new_handle = pqueue_new_handle(pq, slot);
+    }
+
+    memcpy(pq->hole, elem, pq->heap->elem_size);
+    pqueue_sift_up(pq, slot, new_handle);
+    if (handle != NULL)
+    {
+        *handle = new_handle;
+    }
+
+    return 0;
+}
+
+int pqueue_push(struct pqueue *pq, void const *elem)
+{
+    return pqueue_push_handle(pq, elem, NULL);
+}
+
+int pqueue_pop(struct pqueue *pq, void *elem)
+{
+    // Error check
+    assert(pq != NULL && elem != NULL);
+
+    if (vector_empty(pq->heap))
+    {
+        return 1;
+    }
+
+    pqueue_remove_slot(pq, 0, elem);
+
+    return 0;
+}
+
+int pqueue_top(struct pqueue *pq, void *elem)
+{
+    // Error check
+    assert(pq != NULL && elem != NULL);
+
+    if (vector_empty(pq->heap))
+    {
+        return 1;
+    }
+    memcpy(elem, pqueue_slot(pq, 0), pq->heap->elem_size);
+
+    return 0;
+}
+
+// Pointer to the top element, valid until the next modification (NULL if the heap is empty)
+void const *pqueue_top_ptr(struct pqueue *pq)
+{
+    // Error check
+    assert(pq != NULL);
+
+    return vector_empty(pq->heap) ? NULL : pqueue_slot(pq, 0);
+}
+
+/**
+ * @brief Bulk load: append `count` elements && restore the heap order bottom-up (Floyd), O(size + count) instead
+ *        of O(count * log(size)) for one push at a time. `handles` (may be NULL) receives the handle of each element.
+ */
+int pqueue_heapify(struct pqueue *pq, void const *elems, size_t count, size_t *handles)
+{
+    // Error check
+    assert(pq != NULL && (elems != NULL || count == 0));
+
+    size_t old_size = vector_size(pq->heap);
+    if (vector_push_n(pq->heap, elems, count))
+    {
+        return 1;
+    }
+    size_t size = vector_size(pq->heap);
+
+    if (pq->slot_handle != NULL)
+    {
+        if (vector_resize(pq->slot_handle, size))
+        {
+            vector_resize(pq->heap, old_size);
+            return 1;
+        }
+        for (size_t slot = old_size; slot < size; ++slot)
+        {
+            size_t handle = pqueue_new_handle(pq, slot);
+            pqueue_slot_handle(pq)[slot] = handle;
+            if (handles != NULL)
+            {
+                handles[slot - old_size] = handle;
+            }
+        }
+    }
+
+    // Sift down every inner node, the last one first
+    if (size < 2)
+    {
+        return 0;
+    }
+    for (size_t slot = (size - 2) / pq->arity + 1; slot-- > 0; )
+    {
+        memcpy(pq->hole, pqueue_slot(pq, slot), pq->heap->elem_size);
+        pqueue_sift_down(pq, slot, pq->slot_handle != NULL ? pqueue_slot_handle(pq)[slot] : 0);
+    }
+
+    return 0;
+}
+
+// 1 if `handle` names an element that is still in the (indexed) heap
+int pqueue_contains(struct pqueue *pq, size_t handle)
+{
+    // Error check
+    assert(pq != NULL && pq->slot_handle != NULL && "handles need an indexed heap!");
+
+    return handle < vector_size(pq->handle_slot) && pqueue_handle_slot(pq)[handle] != PQUEUE_NO_SLOT;
+}
+
+// Replace the element of `handle` by `elem`, which may go out earlier or later than the old one
+int pqueue_update(struct pqueue *pq, size_t handle, void const *elem)
+{
+    // Error check
+    assert(elem != NULL);
+
+    if (!pqueue_contains(pq, handle))
+    {
+        return 1;
+    }
+
+    size_t slot = pqueue_handle_slot(pq)[handle];
+    memcpy(pq->hole, elem, pq->heap->elem_size);
+    if (slot > 0 && pq->cmp(pq->hole, pqueue_slot(pq, (slot - 1) / pq->arity)) < 0)
+    {
+        pqueue_sift_up(pq, slot, handle);
+    }
+    else
+    {
+        pqueue_sift_down(pq, slot, handle);
+    }
+
+    return 0;
+}
+
+// Move the element of `handle` towards the top: fails (1) if `elem` would go out later than the current element
+int pqueue_decrease_key(struct pqueue *pq, size_t handle, void const *elem)
+{
+    // Error check
+    assert(elem != NULL);
+
+    if (!pqueue_contains(pq, handle))
+    {
+        return 1;
+    }
+
+    size_t slot = pqueue_handle_slot(pq)[handle];
+    if (pq->cmp(elem, pqueue_slot(pq, slot)) > 0)
+    {
+        return 1;
+    }
+    memcpy(pq->hole, elem, pq->heap->elem_size);
+    pqueue_sift_up(pq, slot, handle);
+
+    return 0;
+}
+
+// Take the element of `handle` out of the heap (copied to `elem` unless it is NULL), e.g. a cancelled timer
+int pqueue_remove(struct pqueue *pq, size_t handle, void *elem)
+{
+    if (!pqueue_contains(pq, handle))
+    {
+        return 1;
+    }
+    pqueue_remove_slot(pq, pqueue_handle_slot(pq)[handle], elem);
+
+    return 0;
+}
+
+size_t pqueue_size(struct pqueue const *pq)
+{
+    return vector_size(pq->heap);
+}
+
+int pqueue_empty(struct pqueue const *pq)
+{
+    return vector_empty(pq->heap);
+}
+
+//------------------------------------------------------TESTING-------------------------------------------------------
+
+// Define DATA_STRUCTURES_NO_MAIN to include this file into another program (see Benchmark/main.cpp)
+#ifndef DATA_STRUCTURES_NO_MAIN
+
+static int pqueue_compare_int(void const *a, void const *b)
+{
+    int x = *(int const *) a, y = *(int const *) b;
+    return (x > y) - (x < y);
+}
+
+// Scheduler timer: fires at `deadline`, the id tells timers with equal deadlines apart
+struct pqueue_timer
+{
+    uint64_t deadline;
+    uint64_t id;
+};
+
+static int pqueue_compare_timer(void const *a, void const *b)
+{
+    uint64_t x = ((struct pqueue_timer const *) a)->deadline, y = ((struct pqueue_timer const *) b)->deadline;
+    return (x > y) - (x < y);
+}
+
+struct pqueue_timer_later
+{
+    bool operator()(struct pqueue_timer const &a, struct pqueue_timer const &b) const
+    {
+        return a.deadline > b.deadline;
+    }
+};
+
+static double pqueue_elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Timer workload on `timers` pending timers: bulk load, then `ops` rounds of "fire the earliest timer
+ *        && re-arm it a random interval later" on a plain heap, the same on an indexed one (handle upkeep
+ *        included), then `ops` reschedules of random timers to an earlier deadline. `arity` 0 runs
+ *        std::priority_queue (it has no decrease-key).
+ */
+static void pqueue_timer_benchmark(size_t arity, size_t timers, size_t ops)
+{
+    std::mt19937_64 rng(42);
+    std::vector<struct pqueue_timer> load(timers);
+    for (size_t i = 0; i < timers; ++i)
+    {
+        load[i].deadline    = rng() % (timers * 16);
+        load[i].id          = i;
+    }
+
+    double heapify_ns = 0, fire_ns = 0, indexed_fire_ns = 0, reschedule_ns = 0;
+    uint64_t checksum = 0;
+    if (arity == 0)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::priority_queue<struct pqueue_timer, std::vector<struct pqueue_timer>, struct pqueue_timer_later> pq(load.begin(), load.end());
+        heapify_ns = pqueue_elapsed_ns(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ops; ++i)
+        {
+            struct pqueue_timer t = pq.top();
+            pq.pop();
+            checksum   += t.deadline;
+            t.deadline += 1 + rng() % (timers * 16);
+            pq.push(t);
+        }
+        fire_ns = pqueue_elapsed_ns(start);
+    }
+    else
+    {
+        struct pqueue *pq = pqueue_new(sizeof(struct pqueue_timer), arity, pqueue_compare_timer);
+        auto start = std::chrono::steady_clock::now();
+        pqueue_heapify(pq, load.data(), timers, NULL);
+        heapify_ns = pqueue_elapsed_ns(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ops; ++i)
+        {
+            struct pqueue_timer t;
+            pqueue_pop(pq, &t);
+            checksum   += t.deadline;
+            t.deadline += 1 + rng() % (timers * 16);
+            pqueue_push(pq, &t);
+        }
+        fire_ns = pqueue_elapsed_ns(start);
+        pq = pqueue_delete(pq);
+
+        pq = pqueue_new_indexed(sizeof(struct pqueue_timer), arity, pqueue_compare_timer);
+        size_t *handles = (size_t *) malloc(timers * sizeof(size_t));
+        assert(handles != NULL);
+        pqueue_heapify(pq, load.data(), timers, handles);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ops; ++i)
+        {
+            struct pqueue_timer t;
+            pqueue_pop(pq, &t);
+            t.deadline += 1 + rng() % (timers * 16);
+            pqueue_push_handle(pq, &t, &handles[t.id]);
+        }
+        indexed_fire_ns = pqueue_elapsed_ns(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ops; ++i)
+        {
+            size_t id = rng() % timers;
+            struct pqueue_timer t = *(struct pqueue_timer *) pqueue_slot(pq, pqueue_handle_slot(pq)[handles[id]]);
+            t.deadline -= t.deadline / 4;
+            pqueue_decrease_key(pq, handles[id], &t);
+        }
+        reschedule_ns = pqueue_elapsed_ns(start);
+
+        free(handles);
+        pq = pqueue_delete(pq);
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), arity == 0 ? "std::priority_queue" : "%zu-ary heap", arity);
+    if (arity == 0)
+    {
+        printf("%-20s %8zu timers: heapify %6.2lf ns/timer, fire + re-arm %7.2lf ns/op (checksum %llu)\n",
+               name, timers, heapify_ns / timers, fire_ns / ops, (unsigned long long) checksum);
+        return;
+    }
+    printf("%-20s %8zu timers: heapify %6.2lf ns/timer, fire + re-arm %7.2lf ns/op, indexed %7.2lf ns/op, reschedule %7.2lf ns/op (checksum %llu)\n",
+           name, timers, heapify_ns / timers, fire_ns / ops, indexed_fire_ns / ops, reschedule_ns / ops, (unsigned long long) checksum);
+}
+
+// Should print 1 2 3 5 8 13 21
+//              heapify: 0 1 2 3 4 5 6 7 8 9
+//              timers: 30 (id 2) 40 (id 0) 70 (id 3), cancelled 1, left 0
+//
+// Run with `--bench` to compare 2, 4 && 8-ary heaps (&& std::priority_queue) on a scheduler timer workload
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        const size_t sizes[] = {1000, 100000, 10000000};
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            const size_t arities[] = {0, 2, 4, 8};
+            for (size_t a = 0; a < sizeof(arities) / sizeof(arities[0]); ++a)
+            {
+                pqueue_timer_benchmark(arities[a], sizes[s], 2000000);
+            }
+        }
+
+        return 0;
+    }
+
+    // Plain binary heap: elements come out in ascending order
+    struct pqueue *pq = pqueue_new(sizeof(int), 2, pqueue_compare_int);
+    const int fib[] = {13, 2, 21, 1, 8, 5, 3};
+    for (size_t i = 0; i < sizeof(fib) / sizeof(fib[0]); ++i)
+    {
+        pqueue_push(pq, &fib[i]);
+    }
+    int elem = 0;
+    while (pqueue_pop(pq, &elem) == 0)
+    {
+        printf("%d%c", elem, pqueue_empty(pq) ? '\n' : ' ');
+    }
+    pq = pqueue_delete(pq);
+
+    // 4-ary heap built in O(n) from a bulk load
+    pq = pqueue_new(sizeof(int), PQUEUE_DEFAULT_ARITY, pqueue_compare_int);
+    const int shuffled[] = {7, 3, 9, 0, 5, 1, 8, 2, 6, 4};
+    pqueue_heapify(pq, shuffled, sizeof(shuffled) / sizeof(shuffled[0]), NULL);
+    printf("heapify:");
+    while (pqueue_pop(pq, &elem) == 0)
+    {
+        printf(" %d", elem);
+    }
+    putchar('\n');
+    pq = pqueue_delete(pq);
+
+    // Indexed heap: reschedule one timer earlier, cancel another one
+    pq = pqueue_new_indexed(sizeof(struct pqueue_timer), PQUEUE_DEFAULT_ARITY, pqueue_compare_timer);
+    size_t handles[4];
+    for (uint64_t id = 0; id < 4; ++id)
+    {
+        struct pqueue_timer t = {(id + 4) * 10, id};
+        pqueue_push_handle(pq, &t, &handles[id]);
+    }
+    struct pqueue_timer earlier = {30, 2};
+    pqueue_decrease_key(pq, handles[2], &earlier);
+    struct pqueue_timer cancelled;
+    pqueue_remove(pq, handles[1], &cancelled);
+
+    printf("timers:");
+    struct pqueue_timer t;
+    while (pqueue_pop(pq, &t) == 0)
+    {
+        printf(" %llu (id %llu)", (unsigned long long) t.deadline, (unsigned long long) t.id);
+    }
+    printf(", cancelled %llu, left %zu\n", (unsigned long long) cancelled.id, pqueue_size(pq));
+    pq = pqueue_delete(pq);
+
+    return 0;
+}
+
+#endif // DATA_STRUCTURES_NO_MAIN
+
+/**
+ * @brief   pqueue_top / pqueue_top_ptr / pqueue_size / pqueue_empty / pqueue_contains - O(1),
+ *          pqueue_push - O(log_d(n)) comparisons (one per level on the way up) && amortized O(1) storage growth,
+ *          pqueue_pop / pqueue_remove - O(d * log_d(n)) comparisons (d children per level on the way down),
+ *          pqueue_decrease_key - O(log_d(n)), pqueue_update - O(d * log_d(n)),
+ *          pqueue_heapify - O(n) (Floyd's bottom-up construction),
+ *          every step moves a hole instead of swapping, so each level costs one element copy.
+ *
+ */
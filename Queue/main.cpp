@@ -9,9 +9,32 @@
  */
 
 #include <assert.h> // for assert
+#include <stddef.h> // for size_t && max_align_t
+#include <stdint.h> // for intptr_t
 #include <stdio.h>  // for printf && putchar
-#include <stdlib.h> // for calloc && realloc
-#include <string.h> // for memcpy && memmove
+#include <stdlib.h> // for calloc && realloc && aligned_alloc
+#include <string.h> // for memcpy && strcmp
+
+#include <atomic>   // for std::atomic (lock-free queues)
+#include <chrono>   // for std::chrono (timed blocking operations && benchmark)
+#include <condition_variable>   // for std::condition_variable (blocking queue benchmark baseline)
+#include <deque>    // for std::deque (blocking queue benchmark baseline)
+#include <mutex>    // for std::mutex (blocking queue)
+#include <new>      // for placement new
+#include <thread>   // for std::thread (lock-free queues demo)
+#include <utility>  // for std::move && std::forward (StaticQueue)
+
+#if defined(__linux__)
+#include <linux/futex.h>    // for FUTEX_WAIT_PRIVATE && FUTEX_WAKE_PRIVATE
+#include <sys/syscall.h>    // for SYS_futex
+#include <time.h>           // for struct timespec
+#include <unistd.h>         // for syscall
+#define QUEUE_FUTEX
+#endif
+
+#include "../Common/allocator.h"    // for struct ds_allocator (pluggable ring storage)
+#include "../Common/mem_policy.h"   // for ds_mem_allocator (huge pages && NUMA placement of large queues)
+#include "../Common/stats.h"        // for DS_STATS_* (opt-in instrumentation)
 
 struct queue
 {
@@ -19,45 +42,67 @@ struct queue
     size_t elem_size;
 
     size_t size;
-    size_t capacity;
+    size_t capacity;    // always a power of two
+    size_t mask;        // capacity - 1, wraps indices around the ring
 
-    size_t headIdx;
-    size_t tailIdx;
+    size_t headIdx;     // slot where the next pushed element goes
+    size_t tailIdx;     // slot of the next element to pop
+
+    struct ds_allocator allocator;      // where `data` comes from (malloc unless given to queue_new_alloc)
+    struct ds_mem_policy mem_policy;    // copy of the policy of queue_set_mem_policy, `allocator.ctx` then points here
+
+    DS_STATS_FIELD
 };
 
-const int DEFAULT_QUEUE_CAPACITY    = 10;
+const int DEFAULT_QUEUE_CAPACITY    = 16;   // must be a power of two
 const int POISON                    = 0xDEAD;
 
 
-struct queue *queue_new(size_t elem_size)
+/**
+ * @brief Queue whose ring is allocated with `allocator` (copied into the queue, its context must outlive it).
+ */
+struct queue *queue_new_alloc(size_t elem_size, struct ds_allocator const *allocator)
 {
+    // Error check
+    assert(allocator != NULL);
+
     // Construction of `queue` structure
     struct queue *q = (struct queue *) calloc(1, sizeof(struct queue));
     assert(q != NULL);
 
-    q->data = (char *) calloc(DEFAULT_QUEUE_CAPACITY, elem_size);
+    q->allocator = *allocator;
+    q->data = (char *) ds_allocate_zeroed(&q->allocator, DEFAULT_QUEUE_CAPACITY * elem_size);
     assert(q->data != NULL);
 
     // Fill `queue` structure fields
     q->size         = 0;
     q->capacity     = DEFAULT_QUEUE_CAPACITY;
+    q->mask         = DEFAULT_QUEUE_CAPACITY - 1;
     q->headIdx      = 0;
     q->tailIdx      = 0;
     q->elem_size    = elem_size;
+    DS_STATS_INIT(q);
+    DS_STATS_CAPACITY(q, DS_KIND_QUEUE, q->capacity);
 
     return q;
 }
 
+struct queue *queue_new(size_t elem_size)
+{
+    return queue_new_alloc(elem_size, &DS_DEFAULT_ALLOCATOR);
+}
+
 struct queue *queue_delete(struct queue *q)
 {
     // Error check
     assert(q != NULL && q->data != NULL);
 
     // Destruction of `queue` data structure
-    free(q->data);
+    ds_deallocate(&q->allocator, q->data, q->capacity * q->elem_size);
     
     q->size         = POISON;
     q->capacity     = POISON;
+    q->mask         = POISON;
     q->headIdx      = POISON;
     q->tailIdx      = POISON;
     q->elem_size    = POISON;
@@ -71,16 +116,74 @@ static int queue_reallocation(struct queue *q, size_t new_queue_capacity)
 {
     // Error check
     assert(q != NULL);
+    assert((new_queue_capacity & (new_queue_capacity - 1)) == 0 && "queue capacity must be a power of two!");
+    assert(new_queue_capacity >= q->size);
+
+    // Shrinking: copy live elements into a smaller linear buffer
+    size_t old_queue_capacity = q->capacity;
+    if (new_queue_capacity < old_queue_capacity)
+    {
+        char *tmpData = (char *) ds_allocate(&q->allocator, new_queue_capacity * q->elem_size);
+        if (tmpData == NULL)
+        {
+            return 1;
+        }
+
+        size_t front_len = old_queue_capacity - q->tailIdx;   // elements between tail and the end of the buffer
+        if (front_len > q->size)
+        {
+            front_len = q->size;
+        }
+        memcpy(tmpData, q->data + q->elem_size * q->tailIdx, q->elem_size * front_len);
+        memcpy(tmpData + q->elem_size * front_len, q->data, q->elem_size * (q->size - front_len));
+
+        ds_deallocate(&q->allocator, q->data, old_queue_capacity * q->elem_size);
+        DS_STATS_REALLOC(q, DS_KIND_QUEUE, q->elem_size * q->size, new_queue_capacity);
+        q->data     = tmpData;
+        q->capacity = new_queue_capacity;
+        q->mask     = new_queue_capacity - 1;
+        q->tailIdx  = 0;
+        q->headIdx  = q->size & q->mask;
+
+        return 0;
+    }
 
     // Reallocation
-    char *tmpData = (char *) realloc(q->data, new_queue_capacity * q->elem_size);
+    char *tmpData = (char *) ds_reallocate(&q->allocator, q->data, old_queue_capacity * q->elem_size, new_queue_capacity * q->elem_size);
     if (tmpData == NULL)
     {
         return 1;
     }
 
-    q->data = tmpData;
+    DS_STATS_REALLOC(q, DS_KIND_QUEUE, q->elem_size * old_queue_capacity, new_queue_capacity);
+    q->data     = tmpData;
     q->capacity = new_queue_capacity;
+    q->mask     = new_queue_capacity - 1;
+
+    // Growing a wrapped ring: move the smaller of the two live segments so that
+    // they become contiguous again (once per doubling, at most half of the elements)
+    if (new_queue_capacity > old_queue_capacity && q->size != 0 && q->tailIdx + q->size > old_queue_capacity)
+    {
+        size_t front_len = old_queue_capacity - q->tailIdx;   // [tailIdx, old_capacity)
+        size_t back_len  = q->size - front_len;               // [0, headIdx)
+
+        if (back_len <= front_len)
+        {
+            memcpy(q->data + q->elem_size * old_queue_capacity, q->data, q->elem_size * back_len);
+            DS_STATS_MOVED(q, DS_KIND_QUEUE, q->elem_size * back_len);
+            q->headIdx = (old_queue_capacity + back_len) & q->mask;
+        }
+        else
+        {
+            memcpy(q->data + q->elem_size * (new_queue_capacity - front_len), q->data + q->elem_size * q->tailIdx, q->elem_size * front_len);
+            DS_STATS_MOVED(q, DS_KIND_QUEUE, q->elem_size * front_len);
+            q->tailIdx = new_queue_capacity - front_len;
+        }
+    }
+    else
+    {
+        q->headIdx = (q->tailIdx + q->size) & q->mask;
+    }
 
     return 0;
 }
@@ -92,11 +195,12 @@ int queue_push(struct queue *q, const void *elem)
     {
         return 1;
     }
+    DS_STATS_SCOPE(q, DS_KIND_QUEUE, DS_OP_PUSH);
 
     // Reallocation check
-    if (q->size == q->capacity - 1)
+    if (q->size == q->capacity)
     {
-        int ret = queue_reallocation(q, 2 * q->capacity + 1);
+        int ret = queue_reallocation(q, 2 * q->capacity);
         if (ret)
         {
             return 1;
@@ -106,7 +210,8 @@ int queue_push(struct queue *q, const void *elem)
     // Push
     memcpy(&( q->data[q->elem_size * q->headIdx] ), elem, q->elem_size);
     ++q->size;
-    ++q->headIdx;
+    DS_STATS_SIZE(q, DS_KIND_QUEUE, q->size);
+    q->headIdx = (q->headIdx + 1) & q->mask;
 
     return 0;
 }
@@ -118,25 +223,152 @@ int queue_pop(struct queue *q, void *elem)
     {
         return 1;
     }
+    DS_STATS_SCOPE(q, DS_KIND_QUEUE, DS_OP_POP);
 
-    // Reallocation check
-    if (q->size <= (q->capacity / 2 + (q->capacity & 1)))
+    // Popping
+    memcpy(elem, &( q->data[q->elem_size * q->tailIdx] ), q->elem_size);
+    q->tailIdx = (q->tailIdx + 1) & q->mask;
+    --q->size;
+
+    return 0;
+}
+
+/**
+ * @brief Move the ring into storage of the given allocator && allocate with it from now on.
+ *        Returns 1 && keeps the old storage if the new one can't be allocated.
+ */
+int queue_set_allocator(struct queue *q, struct ds_allocator const *allocator)
+{
+    // Error check
+    if (q == NULL || q->data == NULL || allocator == NULL)
     {
-        // Shifting queue elements
-        memmove(q->data, q->data + q->elem_size * q->tailIdx, q->elem_size * (q->headIdx - q->tailIdx));
-        q->headIdx = q->headIdx - q->tailIdx;
-        q->tailIdx = 0;
+        return 1;
+    }
 
-        int ret = queue_reallocation(q, q->capacity / 2 + (q->capacity & 1));
-        if (ret)
+    // The ring is copied as is, indices stay valid
+    size_t bytes = q->capacity * q->elem_size;
+    char *tmpData = (char *) ds_allocator_move(&q->allocator, allocator, q->data, bytes, bytes);
+    if (tmpData == NULL)
+    {
+        return 1;
+    }
+
+    q->data         = tmpData;
+    q->allocator    = *allocator;
+
+    return 0;
+}
+
+/**
+ * @brief Move the ring into storage of the given policy && allocate with it from now on. The policy is copied
+ *        into the queue. Returns 1 && keeps the old storage (and policy) if the new one can't be allocated.
+ */
+int queue_set_mem_policy(struct queue *q, struct ds_mem_policy const *policy)
+{
+    // Error check
+    if (q == NULL || policy == NULL)
+    {
+        return 1;
+    }
+
+    // The allocator refers to the copy inside the queue; the storage of a previous policy is freed through a
+    // copy of that one, since the field is overwritten first
+    struct ds_mem_policy old_policy;
+    int had_policy = q->allocator.ctx == &q->mem_policy;
+    if (had_policy)
+    {
+        old_policy = q->mem_policy;
+        q->allocator.ctx = &old_policy;
+    }
+
+    q->mem_policy = *policy;
+    struct ds_allocator allocator = ds_mem_allocator(&q->mem_policy);
+    if (queue_set_allocator(q, &allocator) != 0)
+    {
+        if (had_policy)
         {
-            return 1;
+            q->mem_policy = old_policy;
+            q->allocator.ctx = &q->mem_policy;
         }
+        return 1;
     }
 
-    // Popping
-    memcpy(elem, &( q->data[q->elem_size * q->tailIdx] ), q->elem_size);
-    ++q->tailIdx;
+    return 0;
+}
+
+int queue_shrink_to_fit(struct queue *q)
+{
+    // Error check
+    if (q == NULL || q->data == NULL)
+    {
+        return 1;
+    }
+
+    // Find the smallest power of two that still holds all elements
+    size_t new_queue_capacity = DEFAULT_QUEUE_CAPACITY;
+    while (new_queue_capacity < q->size)
+    {
+        new_queue_capacity *= 2;
+    }
+
+    if (new_queue_capacity >= q->capacity)
+    {
+        return 0;
+    }
+
+    return queue_reallocation(q, new_queue_capacity);
+}
+
+/**
+ * Zero-copy access: queue_front_ptr and queue_emplace return pointers into `data`. They stay valid until the next
+ * queue_push/queue_emplace/queue_shrink_to_fit (which may reallocate the ring), until the element is popped/dropped
+ * or the queue is deleted.
+ */
+
+void *queue_front_ptr(struct queue *q)
+{
+    // Error check
+    if (q == NULL || q->data == NULL || q->size == 0)
+    {
+        return NULL;
+    }
+
+    return &( q->data[q->elem_size * q->tailIdx] );
+}
+
+void *queue_emplace(struct queue *q)
+{
+    // Error check
+    if (q == NULL || q->data == NULL)
+    {
+        return NULL;
+    }
+
+    // Reallocation check
+    if (q->size == q->capacity && queue_reallocation(q, 2 * q->capacity))
+    {
+        return NULL;
+    }
+
+    // Hand out the slot at head to be filled in place
+    void *slot = &( q->data[q->elem_size * q->headIdx] );
+    ++q->size;
+    DS_STATS_SIZE(q, DS_KIND_QUEUE, q->size);
+    q->headIdx = (q->headIdx + 1) & q->mask;
+
+    return slot;
+}
+
+int queue_drop(struct queue *q)
+{
+    // Error check
+    if (q == NULL || q->data == NULL || q->size == 0)
+    {
+        return 1;
+    }
+
+    // Popping without copying the element out
+    q->tailIdx = (q->tailIdx + 1) & q->mask;
     --q->size;
 
     return 0;
@@ -158,10 +390,10 @@ void queue_print(struct queue const *q, void (*pf)(void const *data))
     {
         for (int i = 0; i < q->size - 1; ++i)
         {
-            pf(&( q->data[q->elem_size * (q->headIdx - 1 - i)] ));
+            pf(&( q->data[q->elem_size * ((q->headIdx - 1 - i) & q->mask)] ));
             printf(", ");
         }
-        pf(&( q->data[q->elem_size * (q->headIdx - q->size)] ));
+        pf(&( q->data[q->elem_size * q->tailIdx] ));
 
     }
     printf("]\n");
@@ -169,48 +401,1031 @@ void queue_print(struct queue const *q, void (*pf)(void const *data))
     return;
 }
 
+//-------------------------------------------------CONCURRENT QUEUES--------------------------------------------------
 
-void print_element(const void *element)
+/**
+ * Both queues below are bounded rings of power-of-two capacity, keep the type-erased `elem_size` interface of
+ * `struct queue` and never reallocate (a full queue makes push fail instead). Head and tail indices grow
+ * monotonically and are wrapped with `mask` only when a slot is addressed.
+ */
+
+static const size_t QUEUE_CACHE_LINE_SIZE = 64;
+
+static size_t queue_round_up_pow2(size_t n)
 {
-    printf("%d", *((int *) element));
+    size_t pow2 = 2;
+    while (pow2 < n)
+    {
+        pow2 *= 2;
+    }
+
+    return pow2;
 }
 
-int main()
+/**
+ * @brief Wait-free single-producer/single-consumer ring. Each side keeps a private copy of the other side's
+ *        index and only reloads the shared atomic when the copy says the ring is full (empty).
+ */
+struct spsc_queue
 {
-    struct queue *q = queue_new(sizeof(int));
+    char *data;
+    size_t elem_size;
 
-    for (int i = 0; i < 12; ++i)
+    size_t capacity;
+    size_t mask;
+
+    alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<size_t> headIdx;     // written by the producer only
+    size_t cachedTailIdx;                                           // producer's view of tailIdx
+
+    alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<size_t> tailIdx;     // written by the consumer only
+    size_t cachedHeadIdx;                                           // consumer's view of headIdx
+};
+
+struct spsc_queue *spsc_queue_new(size_t elem_size, size_t capacity)
+{
+    // Error check
+    assert(elem_size > 0 && capacity > 0);
+
+    // Construction of `spsc_queue` structure (aligned, so that the index blocks sit on their own cache lines)
+    void *mem = aligned_alloc(alignof(struct spsc_queue), sizeof(struct spsc_queue));
+    assert(mem != NULL);
+    struct spsc_queue *q = new (mem) spsc_queue();
+
+    q->capacity  = queue_round_up_pow2(capacity);
+    q->mask      = q->capacity - 1;
+    q->elem_size = elem_size;
+
+    q->data = (char *) calloc(q->capacity, elem_size);
+    assert(q->data != NULL);
+
+    return q;
+}
+
+struct spsc_queue *spsc_queue_delete(struct spsc_queue *q)
+{
+    // Error check
+    assert(q != NULL && q->data != NULL);
+
+    // Destruction
+    free(q->data);
+    q->~spsc_queue();
+    free(q);
+
+    return NULL;
+}
+
+int spsc_queue_push(struct spsc_queue *q, const void *elem)
+{
+    // Error check
+    if (q == NULL || elem == NULL)
     {
-        queue_push(q, &i);
+        return 1;
     }
-    queue_print(q, print_element);
-    printf("queue size: %d\nqueue capacity: %d\n\n", q->size, q->capacity);
 
-    int elem = 0;
-    for (int i = 0; i < 5; ++i)
+    // Full check (reload the consumer index only when the cached one says so)
+    size_t head = q->headIdx.load(std::memory_order_relaxed);
+    if (head - q->cachedTailIdx == q->capacity)
     {
-        queue_pop(q, &elem);
+        q->cachedTailIdx = q->tailIdx.load(std::memory_order_acquire);
+        if (head - q->cachedTailIdx == q->capacity)
+        {
+            return 1;
+        }
     }
-    queue_print(q, print_element);
-    printf("queue size: %d\nqueue capacity: %d\n", q->size, q->capacity);
-    printf("%d\n\n", queue_empty(q));
 
-    for (int i = 0; i < 9; ++i)
+    // Push && publish the element to the consumer
+    memcpy(&( q->data[q->elem_size * (head & q->mask)] ), elem, q->elem_size);
+    q->headIdx.store(head + 1, std::memory_order_release);
+
+    return 0;
+}
+
+int spsc_queue_pop(struct spsc_queue *q, void *elem)
+{
+    // Error check
+    if (q == NULL || elem == NULL)
     {
-        queue_pop(q, &elem);
+        return 1;
     }
-    queue_print(q, print_element);
-    printf("%d\n", queue_empty(q));
 
-    q = queue_delete(q);
+    // Empty check (reload the producer index only when the cached one says so)
+    size_t tail = q->tailIdx.load(std::memory_order_relaxed);
+    if (tail == q->cachedHeadIdx)
+    {
+        q->cachedHeadIdx = q->headIdx.load(std::memory_order_acquire);
+        if (tail == q->cachedHeadIdx)
+        {
+            return 1;
+        }
+    }
+
+    // Popping && hand the slot back to the producer
+    memcpy(elem, &( q->data[q->elem_size * (tail & q->mask)] ), q->elem_size);
+    q->tailIdx.store(tail + 1, std::memory_order_release);
+
+    return 0;
+}
+
+int spsc_queue_empty(struct spsc_queue const *q)
+{
+    return q->headIdx.load(std::memory_order_acquire) == q->tailIdx.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Bounded multi-producer/multi-consumer ring with sequence-numbered slots (D. Vyukov's design).
+ *        Every slot starts with a sequence counter followed by the element bytes; a producer may fill
+ *        slot `pos` only when its sequence equals `pos`, a consumer may drain it only when it equals `pos + 1`.
+ */
+struct mpmc_queue
+{
+    char *slots;
+    size_t elem_size;
+    size_t slot_size;   // sequence counter + element, rounded up to the counter alignment
+
+    size_t capacity;
+    size_t mask;
+
+    alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<size_t> headIdx;     // next position to push (shared by producers)
+    alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<size_t> tailIdx;     // next position to pop (shared by consumers)
+};
+
+static const size_t MPMC_SLOT_HEADER_SIZE = alignof(max_align_t);  // element bytes stay max-aligned
+
+static inline std::atomic<size_t> *mpmc_slot_seq(struct mpmc_queue const *q, size_t pos)
+{
+    return (std::atomic<size_t> *) &q->slots[q->slot_size * (pos & q->mask)];
+}
+
+static inline char *mpmc_slot_elem(struct mpmc_queue const *q, size_t pos)
+{
+    return &q->slots[q->slot_size * (pos & q->mask) + MPMC_SLOT_HEADER_SIZE];
+}
+
+struct mpmc_queue *mpmc_queue_new(size_t elem_size, size_t capacity)
+{
+    // Error check
+    assert(elem_size > 0 && capacity > 0);
+
+    // Construction of `mpmc_queue` structure
+    void *mem = aligned_alloc(alignof(struct mpmc_queue), sizeof(struct mpmc_queue));
+    assert(mem != NULL);
+    struct mpmc_queue *q = new (mem) mpmc_queue();
+
+    q->capacity  = queue_round_up_pow2(capacity);
+    q->mask      = q->capacity - 1;
+    q->elem_size = elem_size;
+    q->slot_size = (MPMC_SLOT_HEADER_SIZE + elem_size + MPMC_SLOT_HEADER_SIZE - 1) / MPMC_SLOT_HEADER_SIZE * MPMC_SLOT_HEADER_SIZE;
+
+    q->slots = (char *) aligned_alloc(MPMC_SLOT_HEADER_SIZE, q->capacity * q->slot_size);
+    assert(q->slots != NULL);
+
+    // Slot `i` is free for the producer that claims position `i`
+    for (size_t i = 0; i < q->capacity; ++i)
+    {
+        new (mpmc_slot_seq(q, i)) std::atomic<size_t>(i);
+    }
+
+    return q;
+}
+
+struct mpmc_queue *mpmc_queue_delete(struct mpmc_queue *q)
+{
+    // Error check
+    assert(q != NULL && q->slots != NULL);
+
+    // Destruction
+    free(q->slots);
+    q->~mpmc_queue();
+    free(q);
+
+    return NULL;
+}
+
+int mpmc_queue_push(struct mpmc_queue *q, const void *elem)
+{
+    // Error check
+    if (q == NULL || elem == NULL)
+    {
+        return 1;
+    }
+
+    // Claim a position whose slot has been drained
+    size_t pos = q->headIdx.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        size_t seq = mpmc_slot_seq(q, pos)->load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+        if (diff == 0)
+        {
+            if (q->headIdx.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return 1;   // queue is full
+        }
+        else
+        {
+            pos = q->headIdx.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Push && mark the slot as filled
+    memcpy(mpmc_slot_elem(q, pos), elem, q->elem_size);
+    mpmc_slot_seq(q, pos)->store(pos + 1, std::memory_order_release);
 
     return 0;
 }
 
+int mpmc_queue_pop(struct mpmc_queue *q, void *elem)
+{
+    // Error check
+    if (q == NULL || elem == NULL)
+    {
+        return 1;
+    }
+
+    // Claim a position whose slot has been filled
+    size_t pos = q->tailIdx.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        size_t seq = mpmc_slot_seq(q, pos)->load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+
+        if (diff == 0)
+        {
+            if (q->tailIdx.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return 1;   // queue is empty
+        }
+        else
+        {
+            pos = q->tailIdx.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Popping && free the slot for the producers of the next lap
+    memcpy(elem, mpmc_slot_elem(q, pos), q->elem_size);
+    mpmc_slot_seq(q, pos)->store(pos + q->capacity, std::memory_order_release);
+
+    return 0;
+}
+
+int mpmc_queue_empty(struct mpmc_queue const *q)
+{
+    return q->headIdx.load(std::memory_order_acquire) <= q->tailIdx.load(std::memory_order_acquire);
+}
+
+//----------------------------------------------------BLOCKING QUEUE--------------------------------------------------
+
+/**
+ * @brief Bounded mode of `struct queue` for producers that can outrun consumers. The ring never holds more than
+ *        `bound` elements: it is grown to that size once, so pushes never reallocate, and a full queue makes
+ *        producers wait (backpressure) instead of growing. Every operation comes in try, blocking and timed
+ *        variants. The ring is guarded by a mutex, which an uncontended push/pop takes with a single CAS.
+ *        A blocked thread first spins for `spin` rounds on an atomic copy of the size, then parks on a futex
+ *        (Linux) or polls with short sleeps (elsewhere). Notifications are counted under the lock, and a side
+ *        only sends wake-ups to waiters that no earlier wake-up is on its way to. So a burst of pushes costs no
+ *        system call when nobody sleeps, and a single FUTEX_WAKE per sleeping consumer when some do.
+ *        bounded_queue_push_n/pop_n move a whole batch per lock acquisition && notify the other side once for
+ *        all of it: one FUTEX_WAKE for as many sleepers as the batch has elements (free slots) for.
+ */
+struct bounded_queue_waiters
+{
+    std::atomic<uint32_t> seq;  // futex word, bumped on every notification
+    uint32_t waiting;           // threads registered to sleep (guarded by `lock`)
+    uint32_t signaled;          // wake-ups sent && not picked up yet (guarded by `lock`)
+};
+
+struct bounded_queue
+{
+    struct queue *ring;         // the elements, guarded by `lock`
+    size_t bound;               // greatest number of elements held at once
+    int spin;                   // spin rounds of the blocking variants before parking, 0 parks at once
+
+    std::mutex lock;
+    alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<size_t> size;    // ring->size, readable without the lock
+
+    alignas(QUEUE_CACHE_LINE_SIZE) struct bounded_queue_waiters not_empty;  // consumers wait here
+    alignas(QUEUE_CACHE_LINE_SIZE) struct bounded_queue_waiters not_full;   // producers wait here
+};
+
+static const int  BOUNDED_QUEUE_SPIN        = 128;
+static const long BOUNDED_QUEUE_POLL_NS     = 50000;    // sleep between polls where there is no futex
+
+static inline void bounded_queue_cpu_relax()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#endif
+}
+
+// Park until `w->seq` moves away from `seq` or `timeout_ns` (< 0: no timeout) runs out; spurious returns are fine
+static void bounded_queue_park(struct bounded_queue_waiters *w, uint32_t seq, long long timeout_ns)
+{
+#ifdef QUEUE_FUTEX
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer!");
+
+    struct timespec timeout = {(time_t) (timeout_ns / 1000000000), (long) (timeout_ns % 1000000000)};
+    syscall(SYS_futex, (uint32_t *) &w->seq, FUTEX_WAIT_PRIVATE, seq, timeout_ns < 0 ? NULL : &timeout, NULL, 0);
+#else
+    (void) w;
+    (void) seq;
+
+    std::this_thread::sleep_for(std::chrono::nanoseconds(timeout_ns < 0 || timeout_ns > BOUNDED_QUEUE_POLL_NS ? BOUNDED_QUEUE_POLL_NS : timeout_ns));
+#endif
+}
+
+static void bounded_queue_wake(struct bounded_queue_waiters *w, uint32_t count)
+{
+#ifdef QUEUE_FUTEX
+    if (count != 0)
+    {
+        syscall(SYS_futex, (uint32_t *) &w->seq, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+    }
+#else
+    (void) w;
+    (void) count;
+#endif
+}
+
+// Under the lock: how many of the sleepers to wake for `count` new elements (free slots), 0 if nobody needs one
+static uint32_t bounded_queue_notify_locked(struct bounded_queue_waiters *w, size_t count)
+{
+    uint32_t unsignaled = w->waiting - w->signaled;
+    uint32_t wake = count < unsignaled ? (uint32_t) count : unsignaled;
+    if (wake != 0)
+    {
+        w->signaled += wake;
+        w->seq.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return wake;
+}
+
+struct bounded_queue *bounded_queue_new(size_t elem_size, size_t bound)
+{
+    // Error check
+    assert(elem_size > 0 && bound > 0);
+
+    // Construction of `bounded_queue` structure (aligned, so that the size && both waiter blocks get their own lines)
+    void *mem = aligned_alloc(alignof(struct bounded_queue), sizeof(struct bounded_queue));
+    assert(mem != NULL);
+    struct bounded_queue *q = new (mem) bounded_queue();
+
+    q->bound    = bound;
+    q->spin     = std::thread::hardware_concurrency() > 1 ? BOUNDED_QUEUE_SPIN : 0;    // nobody to wait for on one CPU
+    q->ring     = queue_new(elem_size);
+    if (q->ring->capacity < bound)
+    {
+        int ret = queue_reallocation(q->ring, queue_round_up_pow2(bound));
+        assert(ret == 0 && "can't allocate the ring of a bounded queue!");
+        (void) ret;
+    }
+    q->size.store(0, std::memory_order_relaxed);
+
+    q->not_empty.seq.store(0, std::memory_order_relaxed);
+    q->not_empty.waiting    = 0;
+    q->not_empty.signaled   = 0;
+    q->not_full.seq.store(0, std::memory_order_relaxed);
+    q->not_full.waiting     = 0;
+    q->not_full.signaled    = 0;
+
+    return q;
+}
+
+// No thread may be blocked on the queue any more
+struct bounded_queue *bounded_queue_delete(struct bounded_queue *q)
+{
+    // Error check
+    assert(q != NULL);
+
+    // Destruction
+    q->ring = queue_delete(q->ring);
+    q->~bounded_queue();
+    free(q);
+
+    return NULL;
+}
+
+/**
+ * @brief Common body of every push/pop variant: moves as many of the `count` elements as fit (are there) at once.
+ *        `block` = 0: try once; otherwise spin, then park until at least one moves or `timeout_ns` (< 0: no
+ *        timeout) runs out. Returns the number of elements moved, 0 if full (empty).
+ */
+static size_t bounded_queue_transfer(struct bounded_queue *q, void *elems, size_t count, int push, int block, long long timeout_ns)
+{
+    // Error check
+    if (q == NULL || elems == NULL || count == 0)
+    {
+        return 0;
+    }
+
+    struct bounded_queue_waiters *mine   = push ? &q->not_full : &q->not_empty;
+    struct bounded_queue_waiters *theirs = push ? &q->not_empty : &q->not_full;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeout_ns > 0 ? timeout_ns : 0);
+
+    // Spin on the unlocked size first: the other side is likely to be just a few instructions away
+    for (int i = 0; block && i < q->spin; ++i)
+    {
+        size_t size = q->size.load(std::memory_order_relaxed);
+        if (push ? size < q->bound : size > 0)
+        {
+            break;
+        }
+        bounded_queue_cpu_relax();
+    }
+
+    std::unique_lock<std::mutex> lock(q->lock);
+    int registered = 0;
+    for (;;)
+    {
+        if (registered)
+        {
+            --mine->waiting;
+            if (mine->signaled > 0)
+            {
+                --mine->signaled;
+            }
+            registered = 0;
+        }
+
+        // Do the pushes/pops && tell the other side once (no system call unless one of its threads sleeps)
+        size_t ready = push ? q->bound - q->ring->size : q->ring->size;
+        if (ready > 0)
+        {
+            size_t moved = count < ready ? count : ready;
+            for (size_t i = 0; i < moved; ++i)
+            {
+                char *elem = (char *) elems + i * q->ring->elem_size;
+                int ret = push ? queue_push(q->ring, elem) : queue_pop(q->ring, elem);
+                assert(ret == 0);
+                (void) ret;
+            }
+            q->size.store(q->ring->size, std::memory_order_relaxed);
+
+            uint32_t wake = bounded_queue_notify_locked(theirs, moved);
+            lock.unlock();
+            bounded_queue_wake(theirs, wake);
+
+            return moved;
+        }
+
+        long long left_ns = -1;
+        if (timeout_ns >= 0)
+        {
+            left_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now()).count();
+        }
+        if (!block || (timeout_ns >= 0 && left_ns <= 0))
+        {
+            return 0;
+        }
+
+        // Park: the sequence is read under the lock, so a notification sent after unlock() is never missed
+        ++mine->waiting;
+        registered = 1;
+        uint32_t seq = mine->seq.load(std::memory_order_relaxed);
+        lock.unlock();
+        bounded_queue_park(mine, seq, left_ns);
+        lock.lock();
+    }
+}
+
+int bounded_queue_try_push(struct bounded_queue *q, const void *elem)
+{
+    return bounded_queue_transfer(q, (void *) elem, 1, 1, 0, 0) == 1 ? 0 : 1;
+}
+
+int bounded_queue_try_pop(struct bounded_queue *q, void *elem)
+{
+    return bounded_queue_transfer(q, elem, 1, 0, 0, 0) == 1 ? 0 : 1;
+}
+
+// Block while the queue is full
+int bounded_queue_push(struct bounded_queue *q, const void *elem)
+{
+    return bounded_queue_transfer(q, (void *) elem, 1, 1, 1, -1) == 1 ? 0 : 1;
+}
+
+// Block while the queue is empty
+int bounded_queue_pop(struct bounded_queue *q, void *elem)
+{
+    return bounded_queue_transfer(q, elem, 1, 0, 1, -1) == 1 ? 0 : 1;
+}
+
+// Returns 1 if the queue stayed full for `timeout_ns` nanoseconds
+int bounded_queue_push_timed(struct bounded_queue *q, const void *elem, long long timeout_ns)
+{
+    return bounded_queue_transfer(q, (void *) elem, 1, 1, 1, timeout_ns > 0 ? timeout_ns : 0) == 1 ? 0 : 1;
+}
+
+// Returns 1 if the queue stayed empty for `timeout_ns` nanoseconds
+int bounded_queue_pop_timed(struct bounded_queue *q, void *elem, long long timeout_ns)
+{
+    return bounded_queue_transfer(q, elem, 1, 0, 1, timeout_ns > 0 ? timeout_ns : 0) == 1 ? 0 : 1;
+}
+
+/**
+ * @brief Push the `count` contiguous elements of `elems` in order, blocking while the queue is full. Every round
+ *        pushes as many as there is room for under one lock && wakes consumers once for all of them.
+ */
+int bounded_queue_push_n(struct bounded_queue *q, const void *elems, size_t count)
+{
+    // Error check
+    if (q == NULL || elems == NULL)
+    {
+        return 1;
+    }
+
+    for (size_t done = 0; done < count; )
+    {
+        done += bounded_queue_transfer(q, (char *) elems + done * q->ring->elem_size, count - done, 1, 1, -1);
+    }
+
+    return 0;
+}
+
+// Block while the queue is empty, then pop up to `count` elements at once; returns how many were popped
+size_t bounded_queue_pop_n(struct bounded_queue *q, void *elems, size_t count)
+{
+    return bounded_queue_transfer(q, elems, count, 0, 1, -1);
+}
+
+size_t bounded_queue_size(struct bounded_queue const *q)
+{
+    return q->size.load(std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------STATIC QUEUE---------------------------------------------------
+
+/**
+ * @brief Fixed-capacity ring of at most N elements of type T stored inline (N is a power of two, so indices wrap
+ *        with a mask like in `struct queue`): no heap allocation and no reallocation check on push, which only
+ *        fails (returns 1) once N elements are held. Every member is constexpr. T must be default-constructible,
+ *        since a C++17 constexpr constructor has to initialize every element; popped elements are moved out,
+ *        not destroyed, and get overwritten when the ring comes around.
+ */
+template <typename T, size_t N>
+class StaticQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "StaticQueue capacity must be a power of two!");
+
+    static constexpr size_t MASK = N - 1;
+
+public:
+    constexpr StaticQueue() : elems_{}, first_(0), size_(0) {}
+
+    static constexpr size_t capacity()  { return N; }
+    constexpr size_t size() const       { return size_; }
+    constexpr bool empty() const        { return size_ == 0; }
+    constexpr bool full() const         { return size_ == N; }
+
+    constexpr T &front()                { assert(size_ > 0); return elems_[first_]; }
+    constexpr T const &front() const    { assert(size_ > 0); return elems_[first_]; }
+    constexpr T &back()                 { assert(size_ > 0); return elems_[(first_ + size_ - 1) & MASK]; }
+    constexpr T const &back() const     { assert(size_ > 0); return elems_[(first_ + size_ - 1) & MASK]; }
+
+    constexpr int push(T const &elem)
+    {
+        if (size_ == N)
+        {
+            return 1;
+        }
+
+        elems_[(first_ + size_) & MASK] = elem;
+        ++size_;
+
+        return 0;
+    }
+
+    constexpr int push(T &&elem)
+    {
+        if (size_ == N)
+        {
+            return 1;
+        }
+
+        elems_[(first_ + size_) & MASK] = std::move(elem);
+        ++size_;
+
+        return 0;
+    }
+
+    template <typename... Args>
+    constexpr int emplace(Args &&...args)
+    {
+        return push(T(std::forward<Args>(args)...));
+    }
+
+    constexpr int pop(T *elem = NULL)
+    {
+        if (size_ == 0)
+        {
+            return 1;
+        }
+
+        if (elem != NULL)
+        {
+            *elem = std::move(elems_[first_]);
+        }
+        first_ = (first_ + 1) & MASK;
+        --size_;
+
+        return 0;
+    }
+
+    constexpr void clear()
+    {
+        first_  = 0;
+        size_   = 0;
+    }
+
+private:
+    T elems_[N];
+    size_t first_;      // slot of the next element to pop
+    size_t size_;
+};
+
+//------------------------------------------------------TESTING-------------------------------------------------------
+
+// Define DATA_STRUCTURES_NO_MAIN to include this file into another program (see Benchmark/main.cpp)
+#ifndef DATA_STRUCTURES_NO_MAIN
+
+void print_element(const void *element)
+{
+    printf("%d", *((int *) element));
+}
+
+// Compile-time use of StaticQueue: sum of a sliding window of 4 over 1..10, the ring wraps twice
+static constexpr int static_queue_window_sum()
+{
+    StaticQueue<int, 4> window;
+    int sum = 0;
+    for (int i = 1; i <= 10; ++i)
+    {
+        if (window.full())
+        {
+            int oldest = 0;
+            window.pop(&oldest);
+            sum -= oldest;
+        }
+        window.push(i);
+        sum += i;
+    }
+
+    return sum;
+}
+
+static_assert(static_queue_window_sum() == 7 + 8 + 9 + 10, "StaticQueue must work in constant expressions!");
+
+static long long queue_now_ns()
+{
+    return (long long) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int queue_compare_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+// Baseline for the benchmark: what a bounded queue usually looks like (a deque behind a mutex && two condvars)
+struct queue_cv_baseline
+{
+    std::mutex lock;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<long long> items;
+    size_t bound;
+};
+
+/**
+ * @brief Handoff latency: a producer pushes its clock readings through a queue of `bound` slots, the consumer
+ *        subtracts them from its own clock on pop. `kind` 0: std::mutex + std::condition_variable + std::deque,
+ *        1: bounded_queue parking at once, 2: bounded_queue spinning first. Prints p50/p99/p99.9 && throughput.
+ */
+static void bounded_queue_latency(int kind, size_t n, size_t bound)
+{
+    long long *latency = (long long *) malloc(n * sizeof(long long));
+    assert(latency != NULL);
+
+    struct bounded_queue *bq = bounded_queue_new(sizeof(long long), bound);
+    bq->spin = kind == 2 ? BOUNDED_QUEUE_SPIN : 0;
+    struct queue_cv_baseline cv;
+    cv.bound = bound;
+
+    long long start = queue_now_ns();
+    std::thread producer([&]() {
+        for (size_t i = 0; i < n; ++i)
+        {
+            long long stamp = queue_now_ns();
+            if (kind != 0)
+            {
+                bounded_queue_push(bq, &stamp);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(cv.lock);
+            cv.not_full.wait(lock, [&]() { return cv.items.size() < cv.bound; });
+            cv.items.push_back(stamp);
+            lock.unlock();
+            cv.not_empty.notify_one();
+        }
+    });
+    for (size_t i = 0; i < n; ++i)
+    {
+        long long stamp = 0;
+        if (kind != 0)
+        {
+            bounded_queue_pop(bq, &stamp);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(cv.lock);
+            cv.not_empty.wait(lock, [&]() { return !cv.items.empty(); });
+            stamp = cv.items.front();
+            cv.items.pop_front();
+            lock.unlock();
+            cv.not_full.notify_one();
+        }
+        latency[i] = queue_now_ns() - stamp;
+    }
+    producer.join();
+    long long elapsed = queue_now_ns() - start;
+    bq = bounded_queue_delete(bq);
+
+    qsort(latency, n, sizeof(long long), queue_compare_ll);
+    static const char *names[] = {"mutex + condvar", "bounded (park)", "bounded (spin)"};
+    printf("%-16s bound %4zu: p50 %8lld ns, p99 %8lld ns, p99.9 %8lld ns, %6.2lf Mops/s\n", names[kind], bound,
+           latency[n / 2], latency[n / 100 * 99], latency[n / 1000 * 999], (double) n * 1e3 / (double) elapsed);
+    free(latency);
+}
+
+/**
+ * @brief Throughput of one producer && one consumer moving `n` elements through a bounded queue of `bound` slots
+ *        in batches of `batch` (1: bounded_queue_push/pop, otherwise bounded_queue_push_n/pop_n).
+ */
+static void bounded_queue_batch_throughput(size_t n, size_t bound, size_t batch)
+{
+    struct bounded_queue *bq = bounded_queue_new(sizeof(long long), bound);
+    long long *elems = (long long *) calloc(batch, sizeof(long long));
+    assert(elems != NULL);
+
+    long long start = queue_now_ns();
+    std::thread producer([&]() {
+        long long *out = (long long *) calloc(batch, sizeof(long long));
+        assert(out != NULL);
+        for (size_t i = 0; i < n; i += batch)
+        {
+            size_t count = n - i < batch ? n - i : batch;
+            batch == 1 ? bounded_queue_push(bq, out) : bounded_queue_push_n(bq, out, count);
+        }
+        free(out);
+    });
+    for (size_t got = 0; got < n; )
+    {
+        got += batch == 1 ? (bounded_queue_pop(bq, elems) == 0) : bounded_queue_pop_n(bq, elems, batch);
+    }
+    producer.join();
+    long long elapsed = queue_now_ns() - start;
+
+    printf("bounded batch %4zu  bound %4zu: %6.2lf Mops/s\n", batch, bound, (double) n * 1e3 / (double) elapsed);
+    free(elems);
+    bq = bounded_queue_delete(bq);
+}
+
+// Run with `--bench` to measure handoff latency percentiles of the bounded queue against a mutex + condvar queue,
+// && its throughput with single pushes/pops against batched ones
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        const size_t bounds[] = {1, 64, 1024};
+        for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); ++b)
+        {
+            for (int kind = 0; kind < 3; ++kind)
+            {
+                bounded_queue_latency(kind, 1000000, bounds[b]);
+            }
+        }
+
+        const size_t batches[] = {1, 16, 64};
+        for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); ++b)
+        {
+            bounded_queue_batch_throughput(10000000, 1024, batches[b]);
+        }
+
+        return 0;
+    }
+
+    struct queue *q = queue_new(sizeof(int));
+
+    for (int i = 0; i < 12; ++i)
+    {
+        queue_push(q, &i);
+    }
+    queue_print(q, print_element);
+    printf("queue size: %zu\nqueue capacity: %zu\n\n", q->size, q->capacity);
+
+    int elem = 0;
+    for (int i = 0; i < 5; ++i)
+    {
+        queue_pop(q, &elem);
+    }
+    queue_print(q, print_element);
+    printf("queue size: %zu\nqueue capacity: %zu\n", q->size, q->capacity);
+    printf("%d\n\n", queue_empty(q));
+
+    for (int i = 0; i < 9; ++i)
+    {
+        queue_pop(q, &elem);
+    }
+    queue_print(q, print_element);
+    printf("%d\n\n", queue_empty(q));
+
+    // Wrap-around: head and tail indices run past the end of the ring several times
+    for (int i = 0; i < 40; ++i)
+    {
+        queue_push(q, &i);
+        if (i & 1)
+        {
+            queue_pop(q, &elem);
+        }
+    }
+    queue_print(q, print_element);
+    printf("queue size: %zu\nqueue capacity: %zu\n", q->size, q->capacity);
+
+    queue_shrink_to_fit(q);
+    queue_print(q, print_element);
+    printf("queue size: %zu\nqueue capacity: %zu\n", q->size, q->capacity);
+
+    // Fill a slot in place && consume the front without copying it out
+    *(int *) queue_emplace(q) = 40;
+    printf("front: %d\n", *(int *) queue_front_ptr(q));
+    queue_drop(q);
+    printf("front: %d\n\n", *(int *) queue_front_ptr(q));
+
+    // Inline fixed-capacity ring: push fails once it is full
+    StaticQueue<int, 4> sq4;
+    int pushed = 0;
+    while (sq4.push(pushed) == 0)
+    {
+        ++pushed;
+    }
+    sq4.pop();
+    sq4.push(pushed);
+    printf("static: pushed %d, front %d, back %d, size %zu\n\n", pushed, sq4.front(), sq4.back(), sq4.size());
+
+#ifdef DS_STATS
+    ds_stats_dump_json(stdout, "queue", &q->stats);
+#endif
+
+    q = queue_delete(q);
+
+    // Lock-free queues: every pushed value must come out exactly once
+    const long ITEMS = 100000;
+
+    struct spsc_queue *sq = spsc_queue_new(sizeof(long), 1024);
+    long spsc_sum = 0;
+    std::thread spsc_producer([sq, ITEMS]() {
+        for (long i = 1; i <= ITEMS; ++i)
+        {
+            while (spsc_queue_push(sq, &i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (long i = 0, val = 0; i < ITEMS; ++i)
+    {
+        while (spsc_queue_pop(sq, &val))
+        {
+            std::this_thread::yield();
+        }
+        spsc_sum += val;
+    }
+    spsc_producer.join();
+    printf("spsc sum: %ld (expected %ld), empty: %d\n", spsc_sum, ITEMS * (ITEMS + 1) / 2, spsc_queue_empty(sq));
+    sq = spsc_queue_delete(sq);
+
+    struct mpmc_queue *mq = mpmc_queue_new(sizeof(long), 1024);
+    std::atomic<long> mpmc_sum(0);
+    std::thread workers[4];
+    for (int t = 0; t < 2; ++t)
+    {
+        workers[t] = std::thread([mq, ITEMS, t]() {
+            for (long i = 1 + t; i <= ITEMS; i += 2)
+            {
+                while (mpmc_queue_push(mq, &i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        workers[t + 2] = std::thread([mq, ITEMS, &mpmc_sum]() {
+            long val = 0, local_sum = 0;
+            for (long i = 0; i < ITEMS / 2; ++i)
+            {
+                while (mpmc_queue_pop(mq, &val))
+                {
+                    std::this_thread::yield();
+                }
+                local_sum += val;
+            }
+            mpmc_sum += local_sum;
+        });
+    }
+    for (int t = 0; t < 4; ++t)
+    {
+        workers[t].join();
+    }
+    printf("mpmc sum: %ld (expected %ld), empty: %d\n", mpmc_sum.load(), ITEMS * (ITEMS + 1) / 2, mpmc_queue_empty(mq));
+    mq = mpmc_queue_delete(mq);
+
+    // Bounded queue: try_push fails once `bound` elements are in, blocking push waits for the consumer
+    struct bounded_queue *bq = bounded_queue_new(sizeof(long), 4);
+    long accepted = 0;
+    while (bounded_queue_try_push(bq, &accepted) == 0)
+    {
+        ++accepted;
+    }
+    for (long i = 0, val = 0; i < accepted; ++i)
+    {
+        bounded_queue_pop(bq, &val);
+    }
+
+    long bounded_sum = 0;
+    std::thread bounded_producer([bq, ITEMS]() {
+        for (long i = 1; i <= ITEMS; ++i)
+        {
+            bounded_queue_push(bq, &i);
+        }
+    });
+    for (long i = 0, val = 0; i < ITEMS; ++i)
+    {
+        bounded_queue_pop(bq, &val);
+        bounded_sum += val;
+    }
+    bounded_producer.join();
+    long timed_out = 0;
+    int timed = bounded_queue_pop_timed(bq, &timed_out, 1000000);
+    printf("bounded: accepted %ld of 4, sum %ld (expected %ld), timed pop on empty: %d\n", accepted, bounded_sum, ITEMS * (ITEMS + 1) / 2, timed);
+
+    // Batches: the producer hands over 8 elements per lock (the bound splits them), the consumer takes what is there
+    long batch_sum = 0;
+    std::thread batch_producer([bq, ITEMS]() {
+        long batch[8];
+        for (long i = 1; i <= ITEMS; i += 8)
+        {
+            size_t count = 0;
+            for (long j = i; j <= ITEMS && count < 8; ++j)
+            {
+                batch[count++] = j;
+            }
+            bounded_queue_push_n(bq, batch, count);
+        }
+    });
+    for (long got = 0; got < ITEMS; )
+    {
+        long batch[8];
+        size_t count = bounded_queue_pop_n(bq, batch, 8);
+        for (size_t j = 0; j < count; ++j)
+        {
+            batch_sum += batch[j];
+        }
+        got += (long) count;
+    }
+    batch_producer.join();
+    printf("bounded batches: sum %ld (expected %ld), size %zu\n", batch_sum, ITEMS * (ITEMS + 1) / 2, bounded_queue_size(bq));
+    bq = bounded_queue_delete(bq);
+
+    return 0;
+}
+
+#endif // DATA_STRUCTURES_NO_MAIN
+
 /**
  * @brief   queue_empty - O(1)
- *          queue_pop   - O(n), since memmove function asymptotic (in big-O notation) is O(n)
- *          queue_push  - O(1),
+ *          queue_pop   - O(1), the ring never shifts elements, tailIdx just wraps around (mask indexing)
+ *          queue_push  - O(1) amortized, growth doubles the capacity and relinearizes the ring at most once per doubling
+ *          queue_shrink_to_fit - O(n),
+ *          queue_set_allocator / queue_set_mem_policy - O(capacity) (one copy of the ring),
+ *          queue_front_ptr / queue_drop - O(1), queue_emplace - O(1) amortized, none of them copies the element,
+ *          StaticQueue push/pop - O(1) with no allocation at all (the ring lives inside the object),
+ *          spsc_queue_push/pop - O(1) wait-free (one acquire load of the other side's index only when the cached one runs out),
+ *          mpmc_queue_push/pop - O(1) lock-free (one CAS on the shared index per successful operation, retried under contention),
+ *          bounded_queue_try_push/try_pop - O(1), never reallocates (the ring is sized for `bound` up front),
+ *          bounded_queue_push/pop (+ _timed) - O(1) plus waiting; a futex wake-up only when the other side has sleepers,
+ *          bounded_queue_push_n/pop_n - O(count) plus waiting, one lock && at most one futex wake-up per batch,
  *          since the number of operations is proportional to the number of bytes that the stack element represents.
  * 
  */
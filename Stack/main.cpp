@@ -1,7 +1,8 @@
 /**
  * @file main.cpp      
  * @author Vladislav Skvortsov
- * @brief Implementation of stack structure with arbitrary number of elements of any type support (+ basic interface)
+ * @brief Implementation of stack structure with arbitrary number of elements of any type support (+ basic interface,
+ *        Chase-Lev work-stealing deque && a work-stealing thread pool)
  * @version 0.1
  * 
  * @copyright Copyright (c) 2022
@@ -9,11 +10,23 @@
  */
 
 #include <assert.h> // for assert
-#include <stddef.h> // for size_t
+#include <stddef.h> // for size_t && max_align_t
+#include <stdint.h> // for int64_t && uint64_t (work-stealing deque)
 #include <stdio.h>  // for putchar && printf
-#include <stdlib.h> // for calloc && realloc
+#include <stdlib.h> // for calloc && realloc && aligned_alloc
 #include <string.h> // for memcpy && memset
 
+#include <atomic>   // for std::atomic (work-stealing deque)
+#include <chrono>   // for std::chrono (idle workers && benchmark)
+#include <mutex>    // for std::mutex (tasks spawned outside the pool)
+#include <new>      // for placement new
+#include <thread>   // for std::thread (work-stealing pool)
+#include <utility>  // for std::move && std::forward (StaticStack)
+
+#include "../Common/allocator.h"    // for struct ds_allocator (pluggable element storage)
+#include "../Common/mem_policy.h"   // for ds_mem_allocator (huge pages && NUMA placement of large stacks)
+#include "../Common/stats.h"        // for DS_STATS_* (opt-in instrumentation)
+
 struct stack
 {
     char *elems;
@@ -21,8 +34,16 @@ struct stack
 
     int stack_size;
     int stack_capacity;
+    int inline_capacity;    // elements of the small buffer allocated right after the struct (SBO), 0 if none
+    struct ds_allocator allocator;      // where heap `elems` come from (malloc unless given to stack_new_alloc)
+    struct ds_mem_policy mem_policy;    // copy of the policy of stack_set_mem_policy, `allocator.ctx` then points here
+
+    DS_STATS_FIELD
 };
 
+// SBO: the small buffer (if any) starts at the first max-aligned offset after the struct
+static const size_t STACK_INLINE_OFFSET = (sizeof(struct stack) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+
 enum STACK_ERRORS
 {
     NO_ERRORS,
@@ -34,10 +55,14 @@ enum STACK_ERRORS
 static const size_t MIN_STACK_CAPACITY  = 10;
 static const int    REALLOC_COEFF       = 2;
 
-struct stack *stack_new(size_t elem_size)
+/**
+ * @brief Stack whose elements are allocated with `allocator` (copied into the stack, its context must outlive it).
+ */
+struct stack *stack_new_alloc(size_t elem_size, struct ds_allocator const *allocator)
 {
     // Error check
     assert(elem_size > 0 && "new stack size must be greater than zero!");
+    assert(allocator != NULL && "passed allocator is nullptr!");
 
     // Allocating memory for stack
     struct stack *st = (struct stack *) calloc(1, sizeof(struct stack));
@@ -45,9 +70,56 @@ struct stack *stack_new(size_t elem_size)
 
     // Set stack fields
     st->elem_size = elem_size;  // size of each stack object
-    st->elems = (char *) calloc(MIN_STACK_CAPACITY, st->elem_size); // allocating memory (in bytes)
+    st->allocator = *allocator;
+    st->elems = (char *) ds_allocate_zeroed(&st->allocator, MIN_STACK_CAPACITY * st->elem_size); // allocating memory (in bytes)
     st->stack_capacity = MIN_STACK_CAPACITY;
     st->stack_size = 0;
+    DS_STATS_INIT(st);
+    DS_STATS_CAPACITY(st, DS_KIND_STACK, st->stack_capacity);
+
+    return st;
+}
+
+struct stack *stack_new(size_t elem_size)
+{
+    return stack_new_alloc(elem_size, &DS_DEFAULT_ALLOCATOR);
+}
+
+static char *stack_inline_elems(struct stack const *st)
+{
+    return (char *) st + STACK_INLINE_OFFSET;
+}
+
+// Stacks made by stack_new have no small buffer: their separately allocated elems may even start right there
+static int stack_elems_inline(struct stack const *st)
+{
+    return st->inline_capacity > 0 && st->elems == stack_inline_elems(st);
+}
+
+/**
+ * @brief Small-buffer mode: the first `inline_capacity` elements live in the same allocation as the struct, so a
+ *        stack that never outgrows them costs one calloc/free instead of two. Once a push overflows the buffer,
+ *        the elements move to the heap (doubling as usual) and the buffer stays unused until stack_delete.
+ */
+struct stack *stack_new_sbo(size_t elem_size, size_t inline_capacity)
+{
+    // Error check
+    assert(elem_size > 0 && "new stack size must be greater than zero!");
+    assert(inline_capacity > 0 && "inline capacity must be greater than zero!");
+
+    // Allocating memory for stack && its small buffer at once
+    struct stack *st = (struct stack *) calloc(1, STACK_INLINE_OFFSET + inline_capacity * elem_size);
+    assert (st != NULL && "error during stlib calloc function!");
+
+    // Set stack fields
+    st->elem_size = elem_size;
+    st->allocator = DS_DEFAULT_ALLOCATOR;
+    st->elems = stack_inline_elems(st);
+    st->stack_capacity = (int) inline_capacity;
+    st->inline_capacity = (int) inline_capacity;
+    st->stack_size = 0;
+    DS_STATS_INIT(st);
+    DS_STATS_CAPACITY(st, DS_KIND_STACK, st->stack_capacity);
 
     return st;
 }
@@ -57,8 +129,11 @@ struct stack *stack_delete(struct stack *st)
     // Error check
     assert(st != NULL && "passed object st is nullptr!");
 
-    // Destruction
-    free(st->elems);
+    // Destruction (the small buffer, if any, goes away with the struct)
+    if (!stack_elems_inline(st))
+    {
+        ds_deallocate(&st->allocator, st->elems, st->stack_capacity * st->elem_size);
+    }
     free(st);
 
     return NULL;
@@ -72,8 +147,21 @@ static enum STACK_ERRORS stack_realloc(struct stack *st)
         return NULL_PTR_IS_PASSED;
     }
 
-    // Reallocate && check for realloc error
-    char *temp = (char *) realloc(st->elems, REALLOC_COEFF * st->stack_capacity * st->elem_size);
+    // Reallocate && check for realloc error (elements spill out of the small buffer with allocate + memcpy)
+    char *temp = NULL;
+    if (stack_elems_inline(st))
+    {
+        temp = (char *) ds_allocate(&st->allocator, REALLOC_COEFF * st->stack_capacity * st->elem_size);
+        if (temp != NULL)
+        {
+            memcpy(temp, st->elems, st->stack_size * st->elem_size);
+        }
+    }
+    else
+    {
+        temp = (char *) ds_reallocate(&st->allocator, st->elems, st->stack_capacity * st->elem_size,
+                                      REALLOC_COEFF * st->stack_capacity * st->elem_size);
+    }
     if (temp == NULL)
     {
         st = stack_delete(st);
@@ -81,12 +169,77 @@ static enum STACK_ERRORS stack_realloc(struct stack *st)
     }
 
     // Update stack fields
+    DS_STATS_REALLOC(st, DS_KIND_STACK, st->stack_capacity * st->elem_size, REALLOC_COEFF * st->stack_capacity);
     st->elems = temp;
     st->stack_capacity = REALLOC_COEFF * st->stack_capacity;
 
     return NO_ERRORS;
 }
 
+/**
+ * @brief Move the elements into storage of the given allocator (the small buffer, if in use, stays as is) &&
+ *        allocate with it from now on. Returns 1 && keeps the old storage if the new one can't be allocated.
+ */
+int stack_set_allocator(struct stack *st, struct ds_allocator const *allocator)
+{
+    // Error check
+    if (st == NULL || allocator == NULL)
+    {
+        return 1;
+    }
+
+    if (!stack_elems_inline(st))
+    {
+        char *temp = (char *) ds_allocator_move(&st->allocator, allocator, st->elems,
+                                                st->stack_capacity * st->elem_size, st->stack_size * st->elem_size);
+        if (temp == NULL)
+        {
+            return 1;
+        }
+        st->elems = temp;
+    }
+    st->allocator = *allocator;
+
+    return 0;
+}
+
+/**
+ * @brief Move the elements into storage of the given policy && allocate with it from now on. The policy is copied
+ *        into the stack. Returns 1 && keeps the old storage (and policy) if the new one can't be allocated.
+ */
+int stack_set_mem_policy(struct stack *st, struct ds_mem_policy const *policy)
+{
+    // Error check
+    if (st == NULL || policy == NULL)
+    {
+        return 1;
+    }
+
+    // The allocator refers to the copy inside the stack; the storage of a previous policy is freed through a
+    // copy of that one, since the field is overwritten first
+    struct ds_mem_policy old_policy;
+    int had_policy = st->allocator.ctx == &st->mem_policy;
+    if (had_policy)
+    {
+        old_policy = st->mem_policy;
+        st->allocator.ctx = &old_policy;
+    }
+
+    st->mem_policy = *policy;
+    struct ds_allocator allocator = ds_mem_allocator(&st->mem_policy);
+    if (stack_set_allocator(st, &allocator) != 0)
+    {
+        if (had_policy)
+        {
+            st->mem_policy = old_policy;
+            st->allocator.ctx = &st->mem_policy;
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
 int stack_push(struct stack *st, const void *elem)
 {
     // Error check
@@ -94,6 +247,7 @@ int stack_push(struct stack *st, const void *elem)
     {
         return 1;
     }
+    DS_STATS_SCOPE(st, DS_KIND_STACK, DS_OP_PUSH);
 
     // Check for reallocation before push
     if (st->stack_size == st->stack_capacity)
@@ -111,6 +265,7 @@ int stack_push(struct stack *st, const void *elem)
 
     // Show that new element is added
     ++st->stack_size;
+    DS_STATS_SIZE(st, DS_KIND_STACK, st->stack_size);
 
     return 0;    
 }
@@ -122,6 +277,7 @@ int stack_pop(struct stack *st, void *elem)
     {
         return 1;
     }
+    DS_STATS_SCOPE(st, DS_KIND_STACK, DS_OP_POP);
 
     // Pop && error check
     size_t beginning = (st->stack_size - 1) * st->elem_size;  // beginning (in bytes) of element that will be popped
@@ -143,6 +299,7 @@ int stack_top(struct stack *st, void *elem)
     {
         return 1;
     }
+    DS_STATS_SCOPE(st, DS_KIND_STACK, DS_OP_GET);
 
     // Extract top element
     size_t beginning = (st->stack_size - 1) * st->elem_size;
@@ -151,6 +308,63 @@ int stack_top(struct stack *st, void *elem)
     return 0;
 }
 
+/**
+ * Zero-copy access: stack_peek_ptr and stack_emplace return pointers into `elems`. They stay valid until the next
+ * stack_push/stack_emplace (which may reallocate), until the element is popped/dropped or the stack is deleted.
+ */
+
+void *stack_peek_ptr(struct stack *st)
+{
+    // Error check
+    if (st == NULL || st->stack_size == 0)
+    {
+        return NULL;
+    }
+
+    return &st->elems[(st->stack_size - 1) * st->elem_size];
+}
+
+void *stack_emplace(struct stack *st)
+{
+    // Error check
+    if (st == NULL)
+    {
+        return NULL;
+    }
+
+    // Check for reallocation before push
+    if (st->stack_size == st->stack_capacity)
+    {
+        // Reallocate stack elems && check for errors
+        enum STACK_ERRORS ret = stack_realloc(st);
+        if (ret != NO_ERRORS)
+        {
+            return NULL;
+        }
+    }
+
+    // Hand out the new top slot to be filled in place
+    ++st->stack_size;
+    DS_STATS_SIZE(st, DS_KIND_STACK, st->stack_size);
+
+    return &st->elems[(st->stack_size - 1) * st->elem_size];
+}
+
+int stack_drop(struct stack *st)
+{
+    // Error check
+    if (st == NULL || st->stack_size == 0)
+    {
+        return 1;
+    }
+
+    // Erase top stack value (fill with 0's) without copying it out
+    --st->stack_size;
+    memset(&st->elems[st->stack_size * st->elem_size], 0x00, st->elem_size);
+
+    return 0;
+}
+
 int stack_empty(struct stack const *st)
 {
     // Error check
@@ -184,20 +398,757 @@ void stack_print(struct stack const *st, void (*pf)(void const *st))
     printf("]\n");
 }
 
+//-----------------------------------------------------STATIC STACK---------------------------------------------------
+
+/**
+ * @brief Fixed-capacity stack of at most N elements of type T stored inline: no heap allocation and no reallocation
+ *        check on push, which only fails (returns 1, like stack_push on a realloc failure) once N elements are held.
+ *        Every member is constexpr, so a StaticStack can also be used at compile time (see the bracket matcher
+ *        in the demo). T must be default-constructible, since a C++17 constexpr constructor has to initialize
+ *        every element; popped elements are moved out, not destroyed, and get overwritten by the next push.
+ */
+template <typename T, size_t N>
+class StaticStack
+{
+    static_assert(N > 0, "StaticStack capacity must be greater than zero!");
+
+public:
+    constexpr StaticStack() : elems_{}, size_(0) {}
+
+    static constexpr size_t capacity()  { return N; }
+    constexpr size_t size() const       { return size_; }
+    constexpr bool empty() const        { return size_ == 0; }
+    constexpr bool full() const         { return size_ == N; }
+
+    constexpr T &top()                  { assert(size_ > 0); return elems_[size_ - 1]; }
+    constexpr T const &top() const      { assert(size_ > 0); return elems_[size_ - 1]; }
+
+    constexpr int push(T const &elem)
+    {
+        if (size_ == N)
+        {
+            return 1;
+        }
+
+        elems_[size_++] = elem;
+
+        return 0;
+    }
+
+    constexpr int push(T &&elem)
+    {
+        if (size_ == N)
+        {
+            return 1;
+        }
+
+        elems_[size_++] = std::move(elem);
+
+        return 0;
+    }
+
+    template <typename... Args>
+    constexpr int emplace(Args &&...args)
+    {
+        return push(T(std::forward<Args>(args)...));
+    }
+
+    constexpr int pop(T *elem = NULL)
+    {
+        if (size_ == 0)
+        {
+            return 1;
+        }
+
+        --size_;
+        if (elem != NULL)
+        {
+            *elem = std::move(elems_[size_]);
+        }
+
+        return 0;
+    }
+
+    constexpr void clear()              { size_ = 0; }
+
+private:
+    T elems_[N];
+    size_t size_;
+};
+
+//-------------------------------------------------WORK-STEALING DEQUE------------------------------------------------
+
+/**
+ * @brief Chase-Lev work-stealing deque (D. Chase && Y. Lev 2005, memory orderings of N. M. Le et al. 2013).
+ *        The owner thread pushes and pops at the bottom, as on `struct stack`; any other thread steals from
+ *        the top with a CAS. The circular array doubles when it is full. Old arrays stay allocated until
+ *        ws_deque_delete, because a thief may still be copying out of one. Slots are copied word by word with
+ *        relaxed atomics: a thief that races with the owner over a slot reads stale bytes and then loses the
+ *        CAS, instead of taking part in a data race.
+ */
+struct ws_array
+{
+    size_t capacity;            // always a power of two
+    size_t mask;                // capacity - 1
+
+    struct ws_array *retired;   // previous (smaller) array, freed with the deque
+    uint64_t *slots;            // capacity * slot_words words, right after the struct
+};
+
+static const size_t STACK_CACHE_LINE_SIZE   = 64;
+static const size_t WS_MIN_CAPACITY         = 16;
+
+struct ws_deque
+{
+    size_t elem_size;
+    size_t slot_words;          // elem_size in 8-byte words, rounded up
+
+    alignas(STACK_CACHE_LINE_SIZE) std::atomic<int64_t> top;        // next slot to steal, only ever incremented
+    alignas(STACK_CACHE_LINE_SIZE) std::atomic<int64_t> bottom;     // next free slot, written by the owner only
+    std::atomic<struct ws_array *> array;
+};
+
+enum WS_STEAL_RESULT
+{
+    WS_STEAL_OK,
+    WS_STEAL_EMPTY,
+    WS_STEAL_ABORT,     // lost the race for the top element to another thief or the owner, worth retrying
+};
+
+static struct ws_array *ws_array_new(size_t capacity, size_t slot_words)
+{
+    struct ws_array *a = (struct ws_array *) malloc(sizeof(struct ws_array) + capacity * slot_words * sizeof(uint64_t));
+    if (a == NULL)
+    {
+        return NULL;
+    }
+
+    a->capacity = capacity;
+    a->mask     = capacity - 1;
+    a->retired  = NULL;
+    a->slots    = (uint64_t *) (a + 1);
+
+    return a;
+}
+
+static inline uint64_t *ws_slot(struct ws_deque const *dq, struct ws_array const *a, int64_t idx)
+{
+    return &a->slots[dq->slot_words * ((size_t) idx & a->mask)];
+}
+
+static inline void ws_slot_store(struct ws_deque const *dq, uint64_t *slot, void const *elem)
+{
+    for (size_t w = 0; w < dq->slot_words; ++w)
+    {
+        size_t offset = w * sizeof(uint64_t);
+        uint64_t word = 0;
+        memcpy(&word, (char const *) elem + offset, dq->elem_size - offset < sizeof(word) ? dq->elem_size - offset : sizeof(word));
+        __atomic_store_n(&slot[w], word, __ATOMIC_RELAXED);
+    }
+}
+
+static inline void ws_slot_load(struct ws_deque const *dq, uint64_t const *slot, void *elem)
+{
+    for (size_t w = 0; w < dq->slot_words; ++w)
+    {
+        size_t offset = w * sizeof(uint64_t);
+        uint64_t word = __atomic_load_n(&slot[w], __ATOMIC_RELAXED);
+        memcpy((char *) elem + offset, &word, dq->elem_size - offset < sizeof(word) ? dq->elem_size - offset : sizeof(word));
+    }
+}
+
+struct ws_deque *ws_deque_new(size_t elem_size, size_t capacity)
+{
+    // Error check
+    assert(elem_size > 0 && "new deque elem size must be greater than zero!");
+
+    // Construction of `ws_deque` structure (aligned, so that top && bottom sit on their own cache lines)
+    void *mem = aligned_alloc(alignof(struct ws_deque), sizeof(struct ws_deque));
+    assert(mem != NULL);
+    struct ws_deque *dq = new (mem) ws_deque();
+
+    size_t pow2 = WS_MIN_CAPACITY;
+    while (pow2 < capacity)
+    {
+        pow2 *= 2;
+    }
+
+    dq->elem_size   = elem_size;
+    dq->slot_words  = (elem_size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    dq->top.store(0, std::memory_order_relaxed);
+    dq->bottom.store(0, std::memory_order_relaxed);
+    dq->array.store(ws_array_new(pow2, dq->slot_words), std::memory_order_relaxed);
+    assert(dq->array.load(std::memory_order_relaxed) != NULL);
+
+    return dq;
+}
+
+// No thread may use the deque any more
+struct ws_deque *ws_deque_delete(struct ws_deque *dq)
+{
+    // Error check
+    assert(dq != NULL);
+
+    // Destruction of the current array && every retired one
+    struct ws_array *a = dq->array.load(std::memory_order_relaxed);
+    while (a != NULL)
+    {
+        struct ws_array *retired = a->retired;
+        free(a);
+        a = retired;
+    }
+    dq->~ws_deque();
+    free(dq);
+
+    return NULL;
+}
+
+// Owner only: copy the live slots [t, b) into an array twice as big && publish it
+static struct ws_array *ws_deque_grow(struct ws_deque *dq, struct ws_array *a, int64_t b, int64_t t)
+{
+    struct ws_array *grown = ws_array_new(2 * a->capacity, dq->slot_words);
+    if (grown == NULL)
+    {
+        return NULL;
+    }
+
+    for (int64_t i = t; i < b; ++i)
+    {
+        uint64_t const *from = ws_slot(dq, a, i);
+        uint64_t *to = ws_slot(dq, grown, i);
+        for (size_t w = 0; w < dq->slot_words; ++w)
+        {
+            __atomic_store_n(&to[w], __atomic_load_n(&from[w], __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+        }
+    }
+    grown->retired = a;
+    dq->array.store(grown, std::memory_order_release);
+
+    return grown;
+}
+
+/**
+ * @brief Owner only. Returns 1 if the array had to grow && could not be allocated.
+ */
+int ws_deque_push(struct ws_deque *dq, void const *elem)
+{
+    // Error check
+    if (dq == NULL || elem == NULL)
+    {
+        return 1;
+    }
+
+    int64_t b = dq->bottom.load(std::memory_order_relaxed);
+    int64_t t = dq->top.load(std::memory_order_acquire);
+    struct ws_array *a = dq->array.load(std::memory_order_relaxed);
+
+    // Reallocation check
+    if (b - t > (int64_t) a->capacity - 1)
+    {
+        a = ws_deque_grow(dq, a, b, t);
+        if (a == NULL)
+        {
+            return 1;
+        }
+    }
+
+    // Push && publish the element to thieves
+    ws_slot_store(dq, ws_slot(dq, a, b), elem);
+    std::atomic_thread_fence(std::memory_order_release);
+    dq->bottom.store(b + 1, std::memory_order_relaxed);
+
+    return 0;
+}
+
+/**
+ * @brief Owner only: pop the most recently pushed element. Returns 1 if the deque is empty
+ *        (or its last element was just stolen).
+ */
+int ws_deque_pop(struct ws_deque *dq, void *elem)
+{
+    // Error check
+    if (dq == NULL || elem == NULL)
+    {
+        return 1;
+    }
+
+    // Claim the bottom slot first, then look at what thieves did meanwhile
+    int64_t b = dq->bottom.load(std::memory_order_relaxed) - 1;
+    struct ws_array *a = dq->array.load(std::memory_order_relaxed);
+    dq->bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = dq->top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+        dq->bottom.store(b + 1, std::memory_order_relaxed);
+        return 1;
+    }
+
+    // The last element: thieves may want it too, the CAS on top decides
+    if (t == b)
+    {
+        bool won = dq->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        dq->bottom.store(b + 1, std::memory_order_relaxed);
+        if (!won)
+        {
+            return 1;
+        }
+    }
+
+    // Popping (the slot is ours now, nobody overwrites it)
+    ws_slot_load(dq, ws_slot(dq, a, b), elem);
+
+    return 0;
+}
+
+/**
+ * @brief Any thread: take the oldest element. On WS_STEAL_EMPTY && WS_STEAL_ABORT `elem` may be overwritten.
+ */
+enum WS_STEAL_RESULT ws_deque_steal(struct ws_deque *dq, void *elem)
+{
+    // Error check
+    assert(dq != NULL && elem != NULL);
+
+    int64_t t = dq->top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = dq->bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+    {
+        return WS_STEAL_EMPTY;
+    }
+
+    // Copy out before claiming: once top moves on, the owner may reuse the slot
+    struct ws_array *a = dq->array.load(std::memory_order_acquire);
+    ws_slot_load(dq, ws_slot(dq, a, t), elem);
+    if (!dq->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return WS_STEAL_ABORT;
+    }
+
+    return WS_STEAL_OK;
+}
+
+// Exact for the owner when no thief is active, a snapshot otherwise
+size_t ws_deque_size(struct ws_deque const *dq)
+{
+    // Error check
+    assert(dq != NULL);
+
+    int64_t b = dq->bottom.load(std::memory_order_relaxed);
+    int64_t t = dq->top.load(std::memory_order_relaxed);
+
+    return b > t ? (size_t) (b - t) : 0;
+}
+
+//-------------------------------------------------WORK-STEALING POOL-------------------------------------------------
+
+/**
+ * @brief Fork-join scheduler with one ws_deque of tasks per worker thread. A worker runs the newest task of its own
+ *        deque, which is still hot in its cache. When its deque runs dry, it steals the oldest task of a random
+ *        victim; in divide && conquer that is the biggest piece of work left. Tasks spawned from threads outside
+ *        the pool go to a mutex-protected `struct stack`. ws_pool_wait runs tasks while it waits, so nested
+ *        fork-join never blocks a worker.
+ */
+struct ws_group
+{
+    std::atomic<size_t> pending{0};     // tasks spawned into the group && not finished yet
+};
+
+struct ws_task
+{
+    void (*fn)(void *arg);
+    void *arg;
+    struct ws_group *group;
+};
+
+struct ws_pool
+{
+    int workers;
+    struct ws_deque **deques;           // deques[i] is owned by threads[i]
+    std::thread *threads;
+
+    std::mutex inject_lock;
+    struct stack *injected;             // tasks spawned outside the pool
+    std::atomic<size_t> injected_size;  // checked without taking the lock
+
+    std::atomic<int> stop;
+};
+
+static const int WS_IDLE_SPINS      = 64;       // failed rounds of stealing before an idle worker starts to sleep
+static const int WS_IDLE_SLEEP_US   = 50;
+
+// Pool && deque index of the calling thread (-1 outside of any pool)
+static thread_local struct ws_pool *ws_current_pool     = NULL;
+static thread_local int             ws_current_worker   = -1;
+static thread_local uint32_t        ws_victim_seed      = 2463534242u;
+
+static uint32_t ws_next_victim(int workers)
+{
+    ws_victim_seed ^= ws_victim_seed << 13;
+    ws_victim_seed ^= ws_victim_seed >> 17;
+    ws_victim_seed ^= ws_victim_seed << 5;
+
+    return ws_victim_seed % (uint32_t) workers;
+}
+
+// Find one task (own deque, then the others, then the injected ones) && run it. Returns 0 if there was none.
+static int ws_pool_run_one(struct ws_pool *pool, int self)
+{
+    struct ws_task task;
+    int found = self >= 0 && ws_deque_pop(pool->deques[self], &task) == 0;
+
+    for (int i = 0, victim = (int) ws_next_victim(pool->workers); !found && i < pool->workers; ++i, victim = (victim + 1) % pool->workers)
+    {
+        if (victim == self)
+        {
+            continue;
+        }
+
+        enum WS_STEAL_RESULT ret = WS_STEAL_ABORT;
+        while (ret == WS_STEAL_ABORT)
+        {
+            ret = ws_deque_steal(pool->deques[victim], &task);
+        }
+        found = ret == WS_STEAL_OK;
+    }
+
+    if (!found && pool->injected_size.load(std::memory_order_acquire) != 0)
+    {
+        std::lock_guard<std::mutex> lock(pool->inject_lock);
+        found = stack_pop(pool->injected, &task) == 0;
+        if (found)
+        {
+            pool->injected_size.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (!found)
+    {
+        return 0;
+    }
+
+    task.fn(task.arg);
+    task.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+
+    return 1;
+}
+
+static void ws_pool_worker(struct ws_pool *pool, int self)
+{
+    ws_current_pool     = pool;
+    ws_current_worker   = self;
+    ws_victim_seed      = 2463534242u + 2654435761u * (uint32_t) self;
+
+    // Spin on the deques for a while, then poll them with short sleeps
+    int idle = 0;
+    while (!pool->stop.load(std::memory_order_acquire))
+    {
+        if (ws_pool_run_one(pool, self))
+        {
+            idle = 0;
+        }
+        else if (++idle < WS_IDLE_SPINS)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(WS_IDLE_SLEEP_US));
+        }
+    }
+}
+
+/**
+ * @brief Pool of `workers` threads (std::thread::hardware_concurrency() if `workers` <= 0).
+ */
+struct ws_pool *ws_pool_new(int workers)
+{
+    if (workers <= 0)
+    {
+        workers = (int) std::thread::hardware_concurrency();
+        workers = workers > 0 ? workers : 1;
+    }
+
+    // Construction of `ws_pool` structure
+    void *mem = calloc(1, sizeof(struct ws_pool));
+    assert(mem != NULL);
+    struct ws_pool *pool = new (mem) ws_pool();
+
+    pool->workers   = workers;
+    pool->injected  = stack_new(sizeof(struct ws_task));
+    pool->deques    = (struct ws_deque **) calloc(workers, sizeof(struct ws_deque *));
+    assert(pool->deques != NULL);
+    pool->injected_size.store(0, std::memory_order_relaxed);
+    pool->stop.store(0, std::memory_order_relaxed);
+
+    // Every deque exists before the first thief looks at it
+    for (int i = 0; i < workers; ++i)
+    {
+        pool->deques[i] = ws_deque_new(sizeof(struct ws_task), WS_MIN_CAPACITY);
+    }
+    pool->threads = new std::thread[workers];
+    for (int i = 0; i < workers; ++i)
+    {
+        pool->threads[i] = std::thread(ws_pool_worker, pool, i);
+    }
+
+    return pool;
+}
+
+// Tasks still queued are dropped: wait for their groups first
+struct ws_pool *ws_pool_delete(struct ws_pool *pool)
+{
+    // Error check
+    assert(pool != NULL);
+
+    pool->stop.store(1, std::memory_order_release);
+    for (int i = 0; i < pool->workers; ++i)
+    {
+        pool->threads[i].join();
+    }
+    delete[] pool->threads;
+
+    // Destruction
+    for (int i = 0; i < pool->workers; ++i)
+    {
+        pool->deques[i] = ws_deque_delete(pool->deques[i]);
+    }
+    free(pool->deques);
+    pool->injected = stack_delete(pool->injected);
+    pool->~ws_pool();
+    free(pool);
+
+    return NULL;
+}
+
+/**
+ * @brief Schedule fn(arg) as part of `group`. Workers push onto their own deque (no lock), other threads onto
+ *        the shared injection stack. Returns 1 if the task could not be queued.
+ */
+int ws_pool_spawn(struct ws_pool *pool, struct ws_group *group, void (*fn)(void *arg), void *arg)
+{
+    // Error check
+    if (pool == NULL || group == NULL || fn == NULL)
+    {
+        return 1;
+    }
+
+    struct ws_task task = {fn, arg, group};
+    group->pending.fetch_add(1, std::memory_order_relaxed);
+
+    int ret = 0;
+    if (ws_current_pool == pool)
+    {
+        ret = ws_deque_push(pool->deques[ws_current_worker], &task);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(pool->inject_lock);
+        ret = stack_push(pool->injected, &task);
+        if (ret == 0)
+        {
+            pool->injected_size.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    if (ret)
+    {
+        group->pending.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Return once every task of `group` (including the ones they spawned into it) has finished.
+ *        The calling thread runs queued tasks meanwhile, whether it is a worker or not.
+ */
+void ws_pool_wait(struct ws_pool *pool, struct ws_group *group)
+{
+    // Error check
+    assert(pool != NULL && group != NULL);
+
+    int self = ws_current_pool == pool ? ws_current_worker : -1;
+    while (group->pending.load(std::memory_order_acquire) != 0)
+    {
+        if (!ws_pool_run_one(pool, self))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
 //------------------------------------------------------TESTING-------------------------------------------------------
 
+// Define DATA_STRUCTURES_NO_MAIN to include this file into another program (see Benchmark/main.cpp)
+#ifndef DATA_STRUCTURES_NO_MAIN
+
 static void print_double(void const *st)
 {
    printf("%lf", *(double *)st);
 }
 
+// Compile-time use of StaticStack: a parser-style bracket matcher
+static constexpr bool brackets_balanced(const char *str)
+{
+    StaticStack<char, 64> opened;
+    for (; *str != '\0'; ++str)
+    {
+        char c = *str;
+        if (c == '(' || c == '[' || c == '{')
+        {
+            if (opened.push(c))
+            {
+                return false;
+            }
+        }
+        else if (c == ')' || c == ']' || c == '}')
+        {
+            char expected = c == ')' ? '(' : c == ']' ? '[' : '{';
+            if (opened.empty() || opened.top() != expected)
+            {
+                return false;
+            }
+            opened.pop();
+        }
+    }
+
+    return opened.empty();
+}
+
+static_assert(brackets_balanced("{[()()]}") && !brackets_balanced("{[(])}"), "StaticStack must work in constant expressions!");
+
+// Divide && conquer sum on the work-stealing pool: one half is spawned (and maybe stolen), the other one recursed into
+struct ws_sum_job
+{
+    struct ws_pool *pool;
+    long long const *data;
+    size_t n;
+    long long sum;
+};
+
+static const size_t WS_SUM_GRAIN = 4096;
+
+static void ws_sum(void *arg)
+{
+    struct ws_sum_job *job = (struct ws_sum_job *) arg;
+    if (job->n <= WS_SUM_GRAIN)
+    {
+        job->sum = 0;
+        for (size_t i = 0; i < job->n; ++i)
+        {
+            job->sum += job->data[i];
+        }
+        return;
+    }
+
+    struct ws_sum_job left  = {job->pool, job->data, job->n / 2, 0};
+    struct ws_sum_job right = {job->pool, job->data + job->n / 2, job->n - job->n / 2, 0};
+    struct ws_group group;
+    ws_pool_spawn(job->pool, &group, ws_sum, &left);
+    ws_sum(&right);
+    ws_pool_wait(job->pool, &group);
+
+    job->sum = left.sum + right.sum;
+}
+
+static long long ws_parallel_sum(struct ws_pool *pool, long long const *data, size_t n)
+{
+    struct ws_sum_job job = {pool, data, n, 0};
+    struct ws_group group;
+    ws_pool_spawn(pool, &group, ws_sum, &job);
+    ws_pool_wait(pool, &group);
+
+    return job.sum;
+}
+
+static double stack_elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Owner-side cost of the deque against `struct stack`: push `n` ints, pop them all
+static void ws_deque_benchmark(size_t n)
+{
+    struct stack *st = stack_new(sizeof(int));
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < (int) n; ++i)
+    {
+        stack_push(st, &i);
+    }
+    for (int i = 0, elem = 0; i < (int) n; ++i)
+    {
+        stack_pop(st, &elem);
+    }
+    double stack_ns = stack_elapsed_ns(start);
+    st = stack_delete(st);
+
+    struct ws_deque *dq = ws_deque_new(sizeof(int), 0);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < (int) n; ++i)
+    {
+        ws_deque_push(dq, &i);
+    }
+    for (int i = 0, elem = 0; i < (int) n; ++i)
+    {
+        ws_deque_pop(dq, &elem);
+    }
+    double deque_ns = stack_elapsed_ns(start);
+    dq = ws_deque_delete(dq);
+
+    printf("%zu ints push + pop: stack %6.2lf ns/op, ws deque %6.2lf ns/op\n", n, stack_ns / (2 * n), deque_ns / (2 * n));
+}
+
+// Divide && conquer sum of `n` elements with 1, 2, 4 && 8 workers
+static void ws_pool_benchmark(size_t n)
+{
+    long long *data = (long long *) malloc(n * sizeof(long long));
+    assert(data != NULL);
+    for (size_t i = 0; i < n; ++i)
+    {
+        data[i] = (long long) i;
+    }
+
+    for (int workers = 1; workers <= 8; workers *= 2)
+    {
+        struct ws_pool *pool = ws_pool_new(workers);
+        auto start = std::chrono::steady_clock::now();
+        long long sum = ws_parallel_sum(pool, data, n);
+        double ns = stack_elapsed_ns(start);
+        pool = ws_pool_delete(pool);
+
+        printf("%zu elements, %d worker(s): %8.2lf ms%s\n", n, workers, ns / 1e6, sum == (long long) (n * (n - 1) / 2) ? "" : " (wrong sum)");
+    }
+    free(data);
+}
+
 // Should print 81.000000
 //              64.000000
 //              0
 //              [0.000000, 1.000000, 4.000000, 9.000000, 16.000000, 25.000000, 36.000000, 49.000000, 64.000000]
+//              100.000000
+//              static: 3 2 1, full: 1
+//              sbo: inline after push: 1, 1, 1, 1, 0
+//              [0.000000, 1.000000, 4.000000, 9.000000, 16.000000]
+//              arena: 100 elements, top 9801.000000, 1280 bytes used
+//              ws deque: stole 1, popped 5, 3 left
+//              ws pool: sum of 0..999999 = 499999500000 on 4 workers
+//
+// Run with `--bench` to compare the owner side of the work-stealing deque with `struct stack`
+// and to time a divide && conquer sum on 1 .. 8 workers
 
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        ws_deque_benchmark(10000000);
+        ws_pool_benchmark(50000000);
+
+        return 0;
+    }
+
     struct stack *st = stack_new(sizeof (double));
     for (int i = 0; i < 10; i++)
     {
@@ -214,13 +1165,95 @@ int main()
     printf("%d\n", stack_empty(st));
 
     stack_print(st, print_double);
+
+    // Fill the new top in place && read it back without copying
+    *(double *) stack_emplace(st) = 100;
+    printf("%lf\n", *(double *) stack_peek_ptr(st));
+    stack_drop(st);
+
+    // Inline fixed-capacity stack: push fails once it is full
+    StaticStack<int, 3> sst;
+    for (int i = 1; sst.push(i) == 0; ++i)
+    {
+    }
+    int full = sst.full();
+    printf("static:");
+    for (int top = 0; sst.pop(&top) == 0; )
+    {
+        printf(" %d", top);
+    }
+    printf(", full: %d\n", full);
+
+    // Small-buffer stack: the first 4 elements share the allocation of the struct, the 5th one spills to the heap
+    struct stack *small = stack_new_sbo(sizeof(double), 4);
+    for (int i = 0; i < 5; i++)
+    {
+        double sq = i * i;
+        stack_push(small, &sq);
+        printf("%s%d", i ? ", " : "sbo: inline after push: ", small->elems == stack_inline_elems(small));
+    }
+    putchar('\n');
+    stack_print(small, print_double);
+    small = stack_delete(small);
+
+    // Stack on an arena: the storage is the most recent arena block, so every doubling happens in place
+    struct ds_arena *arena = ds_arena_new(4096);
+    struct ds_allocator on_arena = ds_arena_allocator(arena);
+    struct stack *scratch = stack_new_alloc(sizeof(double), &on_arena);
+    for (int i = 0; i < 100; i++)
+    {
+        double sq = i * i;
+        stack_push(scratch, &sq);
+    }
+    stack_top(scratch, &tmp);
+    printf("arena: %d elements, top %lf, %zu bytes used\n", scratch->stack_size, tmp, arena->bytes_used);
+    scratch = stack_delete(scratch);
+    arena = ds_arena_delete(arena);
+
+    // Work-stealing deque: the owner works LIFO at the bottom, a thief takes the oldest element from the top
+    struct ws_deque *dq = ws_deque_new(sizeof(int), 0);
+    for (int i = 1; i <= 5; i++)
+    {
+        ws_deque_push(dq, &i);
+    }
+    int stolen = 0, popped = 0;
+    ws_deque_steal(dq, &stolen);
+    ws_deque_pop(dq, &popped);
+    printf("ws deque: stole %d, popped %d, %zu left\n", stolen, popped, ws_deque_size(dq));
+    dq = ws_deque_delete(dq);
+
+    // Work-stealing pool: the halves of a divide && conquer sum are spread over the workers
+    const size_t N = 1000000;
+    long long *data = (long long *) malloc(N * sizeof(long long));
+    for (size_t i = 0; i < N; ++i)
+    {
+        data[i] = (long long) i;
+    }
+    struct ws_pool *pool = ws_pool_new(4);
+    printf("ws pool: sum of 0..%zu = %lld on %d workers\n", N - 1, ws_parallel_sum(pool, data, N), pool->workers);
+    pool = ws_pool_delete(pool);
+    free(data);
+
+#ifdef DS_STATS
+    ds_stats_dump_text(stdout, "stack", &st->stats);
+#endif
+
     st = stack_delete(st);
 }
 
+#endif // DATA_STRUCTURES_NO_MAIN
+
 /**
  * @brief   stack_push is O(1)
  *          stack_pop is O(1)
+ *          stack_new_sbo is O(1) with a single allocation for the struct && its first `inline_capacity` elements,
+ *          stack_set_allocator / stack_set_mem_policy are O(n) (one copy into the new storage),
  *          stack_top is O(1), 
+ *          stack_peek_ptr / stack_emplace / stack_drop are O(1) and do not copy the element at all,
+ *          StaticStack push/pop/top are O(1) with no allocation at all (the elements live inside the object),
+ *          ws_deque_push / ws_deque_pop are O(1) amortized for the owner (one fence, a CAS only for the last element),
+ *          ws_deque_steal is O(1) with one CAS (lock-free: a failed CAS means another thread made progress),
+ *          ws_pool_spawn is O(1) without a lock from a worker, ws_pool_wait runs queued tasks instead of blocking,
  *          since the number of operations is proportional to the number of bytes that the stack element represents.
  * 
  */
@@ -8,11 +8,59 @@
  * 
  */
 
+// Guarded, because other structures built on `struct vector` include this file too (see PriorityQueue/main.cpp)
+#ifndef DATA_STRUCTURES_VECTOR_MAIN_CPP
+#define DATA_STRUCTURES_VECTOR_MAIN_CPP
+
 #include <assert.h> // for assert
-#include <stddef.h> // for size_t
+#include <stddef.h> // for size_t && max_align_t
+#include <stdint.h> // for int32_t && int64_t && uint64_t
 #include <stdio.h>  // for printf
-#include <stdlib.h> // for malloc (not calloc because calloc inits elems with 0's, the task says not to init them)
-#include <string.h> // for memcpy
+#include <stdlib.h> // for malloc (not calloc because calloc inits elems with 0's, the task says not to init them) && aligned_alloc
+#include <string.h> // for memcpy && strcmp
+
+#include <atomic>       // for std::atomic (snapshot vector)
+#include <chrono>       // for std::chrono (benchmark)
+#include <condition_variable> // for std::condition_variable (parallel algorithms pool)
+#include <memory>       // for std::unique_ptr (Vector<T> demo)
+#include <mutex>        // for std::mutex (snapshot vector writers && parallel algorithms pool)
+#include <new>          // for placement new
+#include <shared_mutex> // for std::shared_mutex (snapshot vector benchmark baseline)
+#include <thread>       // for std::thread (snapshot vector && parallel algorithms)
+#include <type_traits>  // for std::is_trivially_copyable
+#include <utility>      // for std::move && std::forward && std::swap
+
+#include "../Common/allocator.h"    // for struct ds_allocator (pluggable element storage)
+#include "../Common/mem_policy.h"   // for ds_mem_allocator (huge pages && NUMA placement of large vectors)
+#include "../Common/stats.h"        // for DS_STATS_* (opt-in instrumentation)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>  // for SSE4.2 && AVX2 intrinsics (search kernels)
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VECTOR_MMAP 1
+#include <fcntl.h>      // for open
+#include <sys/mman.h>   // for mmap && mremap && msync
+#include <sys/stat.h>   // for fstat
+#include <unistd.h>     // for ftruncate && close
+#endif
+
+/**
+ * @brief Growth/shrink policy of a vector. A push into a full vector grows capacity to
+ *        `growth_factor * capacity + 1`; a pop that leaves the vector at most `shrink_threshold` full
+ *        shrinks capacity by `growth_factor`. Keeping `shrink_threshold < 1 / growth_factor` leaves
+ *        headroom after a shrink, so alternating push/pop at the boundary does not thrash the allocator.
+ */
+struct vector_policy
+{
+    double growth_factor;       // > 1
+    double shrink_threshold;    // in [0, 1 / growth_factor), 0 means "never shrink"
+    size_t min_capacity;        // capacity is never shrunk below this value
+};
+
+static const struct vector_policy VECTOR_DEFAULT_POLICY     = {2.0, 0.25, 16};
+static const struct vector_policy VECTOR_NEVER_SHRINK_POLICY = {2.0, 0.00, 0};
 
 struct vector
 {
@@ -21,37 +69,530 @@ struct vector
 
     size_t size;
     size_t capacity;
+
+    struct vector_policy policy;
+    size_t grow_reallocs;       // number of realloc calls that grew `elems`
+    size_t shrink_reallocs;     // number of realloc calls that shrunk `elems`
+
+    size_t inline_capacity;     // elements of the small buffer allocated right after the struct (SBO), 0 if none
+    struct vector_mapping *mapping;     // backing file of vector_open_mapped, NULL for heap vectors
+    struct ds_allocator allocator;      // where heap `elems` come from (malloc unless given to vector_new_alloc)
+    struct ds_mem_policy mem_policy;    // copy of the policy of vector_set_mem_policy, `allocator.ctx` then points here
+
+    DS_STATS_FIELD
 };
 
-struct vector *vector_new(size_t elems, size_t elem_size)
+// SBO: the small buffer (if any) starts at the first max-aligned offset after the struct
+static const size_t VECTOR_INLINE_OFFSET = (sizeof(struct vector) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+
+/**
+ * @brief Vector whose elements are allocated with `allocator` (copied into the vector, its context must outlive it).
+ */
+struct vector *vector_new_alloc(size_t elems, size_t elem_size, struct ds_allocator const *allocator)
 {
+    // Error check
+    assert(allocator != NULL);
+
     // Allocate memory for structure
     struct vector *v = (struct vector *) malloc(sizeof(struct vector));
     assert(v != NULL);
 
     // Initialize basic vector fields
-    v->elems = (void *) malloc(elem_size * elems); // allocating bytes for vector elements
+    v->allocator = *allocator;
+    v->elems = (void *) ds_allocate(&v->allocator, elem_size * elems); // allocating bytes for vector elements
     assert(v->elems != NULL);
     
     v->size         = elems;
     v->capacity     = elems;
     v->elem_size    = elem_size;
 
+    v->policy           = VECTOR_DEFAULT_POLICY;
+    v->grow_reallocs    = 0;
+    v->shrink_reallocs  = 0;
+    v->inline_capacity  = 0;
+    v->mapping          = NULL;
+    DS_STATS_INIT(v);
+    DS_STATS_SIZE(v, DS_KIND_VECTOR, v->size);
+    DS_STATS_CAPACITY(v, DS_KIND_VECTOR, v->capacity);
+
+    return v;
+}
+
+struct vector *vector_new(size_t elems, size_t elem_size)
+{
+    return vector_new_alloc(elems, elem_size, &DS_DEFAULT_ALLOCATOR);
+}
+
+static void *vector_inline_elems(struct vector const *v)
+{
+    return (char *) v + VECTOR_INLINE_OFFSET;
+}
+
+// Vectors made by vector_new have no small buffer: their separately allocated elems may even start right there
+static int vector_elems_inline(struct vector const *v)
+{
+    return v->inline_capacity > 0 && v->elems == vector_inline_elems(v);
+}
+
+/**
+ * @brief Small-buffer mode: up to `inline_capacity` elements live in the same allocation as the struct, so a
+ *        vector that never outgrows them costs one malloc/free instead of two. Growing past the buffer moves
+ *        the elements to the heap; a shrink that fits into the buffer again moves them back && frees the block.
+ */
+struct vector *vector_new_sbo(size_t elems, size_t elem_size, size_t inline_capacity)
+{
+    // Error check
+    assert(inline_capacity > 0);
+
+    // Allocate memory for structure && its small buffer at once
+    struct vector *v = (struct vector *) malloc(VECTOR_INLINE_OFFSET + inline_capacity * elem_size);
+    assert(v != NULL);
+
+    // Initialize basic vector fields, elements go to the heap only if they do not fit
+    v->inline_capacity = inline_capacity;
+    v->allocator = DS_DEFAULT_ALLOCATOR;
+    if (elems <= inline_capacity)
+    {
+        v->elems    = vector_inline_elems(v);
+        v->capacity = inline_capacity;
+    }
+    else
+    {
+        v->elems    = (void *) ds_allocate(&v->allocator, elem_size * elems);
+        assert(v->elems != NULL);
+        v->capacity = elems;
+    }
+
+    v->size         = elems;
+    v->elem_size    = elem_size;
+
+    v->policy           = VECTOR_DEFAULT_POLICY;
+    v->grow_reallocs    = 0;
+    v->shrink_reallocs  = 0;
+    v->mapping          = NULL;
+    DS_STATS_INIT(v);
+    DS_STATS_SIZE(v, DS_KIND_VECTOR, v->size);
+    DS_STATS_CAPACITY(v, DS_KIND_VECTOR, v->capacity);
+
+    return v;
+}
+
+//----------------------------------------------------MAPPED STORAGE--------------------------------------------------
+
+/**
+ * @brief File-backed mode: `elems` is a shared mapping of a file that starts with a one-page header (magic, elem_size,
+ *        size, capacity) followed by the elements. Growing/shrinking resizes the file with ftruncate && the mapping
+ *        with mremap (page tables move, bytes do not), and vector_open_mapped on an existing file maps it back in
+ *        O(1) with no parsing, so a restarted process only pays page faults for the pages it touches.
+ *        `size` reaches the header on vector_sync and vector_delete; after a crash the file reopens with the
+ *        last synced size.
+ */
+struct vector_file_header
+{
+    char magic[8];
+    uint64_t elem_size;
+    uint64_t size;
+    uint64_t capacity;
+};
+
+struct vector_mapping
+{
+    int fd;
+    char *base;         // header page, the elements follow at VECTOR_FILE_HEADER_SIZE
+    size_t bytes;
+};
+
+static const char   VECTOR_FILE_MAGIC[8]    = {'D', 'S', 'V', 'E', 'C', 'T', 'O', 'R'};
+static const size_t VECTOR_FILE_HEADER_SIZE = 4096;     // keeps the elements page-aligned
+
+#ifdef VECTOR_MMAP
+
+struct vector *vector_open_mapped(char const *path, size_t elem_size)
+{
+    // Error check
+    assert(path != NULL && elem_size > 0);
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    // A new (empty) file gets a header && room for the minimal capacity, an existing one is taken as is
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (st.st_size != 0 && (size_t) st.st_size < VECTOR_FILE_HEADER_SIZE))
+    {
+        close(fd);
+        return NULL;
+    }
+    int fresh = st.st_size == 0;
+    size_t bytes = fresh ? VECTOR_FILE_HEADER_SIZE + VECTOR_DEFAULT_POLICY.min_capacity * elem_size : (size_t) st.st_size;
+    if (fresh && ftruncate(fd, (off_t) bytes) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    char *base = (char *) mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    struct vector_file_header *header = (struct vector_file_header *) base;
+    if (fresh)
+    {
+        memcpy(header->magic, VECTOR_FILE_MAGIC, sizeof(VECTOR_FILE_MAGIC));
+        header->elem_size   = elem_size;
+        header->size        = 0;
+        header->capacity    = VECTOR_DEFAULT_POLICY.min_capacity;
+    }
+    else if (memcmp(header->magic, VECTOR_FILE_MAGIC, sizeof(VECTOR_FILE_MAGIC)) != 0 || header->elem_size != elem_size ||
+             header->size > header->capacity || VECTOR_FILE_HEADER_SIZE + header->capacity * elem_size > bytes)
+    {
+        munmap(base, bytes);
+        close(fd);
+        return NULL;
+    }
+
+    // Allocate memory for structure && mapping description
+    struct vector *v = (struct vector *) malloc(sizeof(struct vector));
+    struct vector_mapping *mapping = (struct vector_mapping *) malloc(sizeof(struct vector_mapping));
+    assert(v != NULL && mapping != NULL);
+
+    mapping->fd     = fd;
+    mapping->base   = base;
+    mapping->bytes  = bytes;
+
+    v->elems        = base + VECTOR_FILE_HEADER_SIZE;
+    v->size         = header->size;
+    v->capacity     = header->capacity;
+    v->elem_size    = elem_size;
+
+    v->policy           = VECTOR_DEFAULT_POLICY;
+    v->grow_reallocs    = 0;
+    v->shrink_reallocs  = 0;
+    v->inline_capacity  = 0;
+    v->mapping          = mapping;
+    v->allocator        = DS_DEFAULT_ALLOCATOR;
+    DS_STATS_INIT(v);
+    DS_STATS_SIZE(v, DS_KIND_VECTOR, v->size);
+    DS_STATS_CAPACITY(v, DS_KIND_VECTOR, v->capacity);
+
     return v;
 }
 
+// Resize the file && its mapping to `new_capacity` elements, returns the new `elems` or NULL
+static void *vector_mapping_resize(struct vector *v, size_t new_capacity)
+{
+    struct vector_mapping *m = v->mapping;
+    size_t new_bytes = VECTOR_FILE_HEADER_SIZE + new_capacity * v->elem_size;
+
+    // The file grows before the mapping && shrinks after it, so no mapped page is ever past its end
+    if (new_bytes > m->bytes && ftruncate(m->fd, (off_t) new_bytes) != 0)
+    {
+        return NULL;
+    }
+
+#ifdef __linux__
+    char *base = (char *) mremap(m->base, m->bytes, new_bytes, MREMAP_MAYMOVE);
+#else
+    // Without mremap: map the file again next to the old mapping (both share the same pages) && drop the old one
+    char *base = (char *) mmap(NULL, new_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, 0);
+    if (base != MAP_FAILED)
+    {
+        munmap(m->base, m->bytes);
+    }
+#endif
+    if (base == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // Shrinking the file is best effort: a failure only leaves unused bytes at its end
+    if (new_bytes < m->bytes)
+    {
+        int ret = ftruncate(m->fd, (off_t) new_bytes);
+        (void) ret;
+    }
+
+    m->base     = base;
+    m->bytes    = new_bytes;
+    ((struct vector_file_header *) base)->capacity = new_capacity;
+
+    return base + VECTOR_FILE_HEADER_SIZE;
+}
+
+int vector_sync(struct vector *v)
+{
+    // Error check
+    assert(v != NULL);
+
+    if (v->mapping == NULL)
+    {
+        return 1;
+    }
+
+    // Store the size into the header && flush the dirty pages to the file
+    struct vector_file_header *header = (struct vector_file_header *) v->mapping->base;
+    header->size        = v->size;
+    header->capacity    = v->capacity;
+
+    return msync(v->mapping->base, v->mapping->bytes, MS_SYNC) != 0;
+}
+
+static void vector_mapping_close(struct vector *v)
+{
+    struct vector_file_header *header = (struct vector_file_header *) v->mapping->base;
+    header->size        = v->size;
+    header->capacity    = v->capacity;
+
+    munmap(v->mapping->base, v->mapping->bytes);
+    close(v->mapping->fd);
+    free(v->mapping);
+}
+
+#else
+
+struct vector *vector_open_mapped(char const *path, size_t elem_size)
+{
+    (void) path;
+    (void) elem_size;
+
+    return NULL;
+}
+
+static void *vector_mapping_resize(struct vector *v, size_t new_capacity)
+{
+    (void) v;
+    (void) new_capacity;
+
+    return NULL;
+}
+
+int vector_sync(struct vector *v)
+{
+    (void) v;
+
+    return 1;
+}
+
+static void vector_mapping_close(struct vector *v)
+{
+    (void) v;
+}
+
+#endif // VECTOR_MMAP
+
 struct vector *vector_delete(struct vector *v)
 {
     // Error check
     assert(v != NULL);
 
-    // Delete vector object
-    free(v->elems);
+    // Delete vector object (the small buffer, if any, goes away with the struct; a mapped file stays on disk)
+    if (v->mapping != NULL)
+    {
+        vector_mapping_close(v);
+    }
+    else if (!vector_elems_inline(v))
+    {
+        ds_deallocate(&v->allocator, v->elems, v->capacity * v->elem_size);
+    }
     free(v);
 
     return NULL;
 }
 
+int vector_set_policy(struct vector *v, struct vector_policy const *policy)
+{
+    // Error check
+    assert(v != NULL && policy != NULL);
+
+    if (policy->growth_factor <= 1.0 || policy->shrink_threshold < 0.0 ||
+        policy->shrink_threshold * policy->growth_factor >= 1.0)
+    {
+        return 1;
+    }
+
+    v->policy = *policy;
+
+    return 0;
+}
+
+/**
+ * @brief Move the elements into storage of the given allocator (a small buffer or a mapped file in use stays as
+ *        is) && allocate with it from now on. Returns 1 && keeps the old storage if the new one can't be allocated.
+ */
+int vector_set_allocator(struct vector *v, struct ds_allocator const *allocator)
+{
+    // Error check
+    assert(v != NULL && allocator != NULL);
+
+    if (v->mapping == NULL && !vector_elems_inline(v))
+    {
+        size_t bytes = v->capacity * v->elem_size;
+        void *new_elems = ds_allocate(allocator, bytes);
+        if (new_elems == NULL && bytes != 0)
+        {
+            return 1;
+        }
+
+        memcpy(new_elems, v->elems, v->size * v->elem_size);
+        ds_deallocate(&v->allocator, v->elems, bytes);
+        v->elems = new_elems;
+    }
+    v->allocator = *allocator;
+
+    return 0;
+}
+
+/**
+ * @brief Move the elements into storage of the given policy && allocate with it from now on. The policy is copied
+ *        into the vector. Returns 1 && keeps the old storage (and policy) if the new one can't be allocated.
+ */
+int vector_set_mem_policy(struct vector *v, struct ds_mem_policy const *policy)
+{
+    // Error check
+    assert(v != NULL && policy != NULL);
+
+    // The allocator refers to the copy inside the vector; the storage of a previous policy is freed through a
+    // copy of that one, since the field is overwritten first
+    struct ds_mem_policy old_policy;
+    int had_policy = v->allocator.ctx == &v->mem_policy;
+    if (had_policy)
+    {
+        old_policy = v->mem_policy;
+        v->allocator.ctx = &old_policy;
+    }
+
+    v->mem_policy = *policy;
+    struct ds_allocator allocator = ds_mem_allocator(&v->mem_policy);
+    if (vector_set_allocator(v, &allocator) != 0)
+    {
+        if (had_policy)
+        {
+            v->mem_policy = old_policy;
+            v->allocator.ctx = &v->mem_policy;
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+static int vector_reallocation(struct vector *v, size_t new_capacity)
+{
+    // Error check
+    assert(v != NULL && new_capacity != 0);
+
+    // Small buffer: moving into it (or staying there) needs no allocation, capacity becomes the whole buffer
+    int was_inline = vector_elems_inline(v);
+    void *new_data_location = NULL;
+    if (new_capacity <= v->inline_capacity)
+    {
+        if (was_inline)
+        {
+            return 0;
+        }
+
+        new_data_location = vector_inline_elems(v);
+        memcpy(new_data_location, v->elems, (v->size < new_capacity ? v->size : new_capacity) * v->elem_size);
+        ds_deallocate(&v->allocator, v->elems, v->capacity * v->elem_size);
+        new_capacity = v->inline_capacity;
+    }
+    // Leaving the small buffer: the elements are copied out, the buffer stays unused
+    else if (was_inline)
+    {
+        new_data_location = ds_allocate(&v->allocator, new_capacity * v->elem_size);
+        if (new_data_location == NULL)
+        {
+            return 1;
+        }
+        memcpy(new_data_location, v->elems, v->size * v->elem_size);
+    }
+    // File-backed elements are remapped, not copied
+    else if (v->mapping != NULL)
+    {
+        new_data_location = vector_mapping_resize(v, new_capacity);
+        if (new_data_location == NULL)
+        {
+            return 1;
+        }
+    }
+    // Reallocation
+    else
+    {
+        new_data_location = ds_reallocate(&v->allocator, v->elems, v->capacity * v->elem_size, new_capacity * v->elem_size);
+        if (new_data_location == NULL)
+        {
+            return 1;
+        }
+    }
+
+    // Update vector fields
+    DS_STATS_REALLOC(v, DS_KIND_VECTOR, v->mapping ? 0 : (new_capacity < v->capacity ? new_capacity : v->capacity) * v->elem_size, new_capacity);
+    if (new_capacity > v->capacity)
+    {
+        ++v->grow_reallocs;
+    }
+    else
+    {
+        ++v->shrink_reallocs;
+    }
+    v->elems    = new_data_location;
+    v->capacity = new_capacity;
+
+    return 0;
+}
+
+static int vector_grow_check(struct vector *v, size_t required_capacity)
+{
+    // Apply the growth policy as many times as needed, but reallocate only once
+    size_t new_capacity = v->capacity;
+    while (new_capacity < required_capacity)
+    {
+        new_capacity = (size_t) (v->policy.growth_factor * new_capacity) + 1;
+    }
+
+    if (new_capacity == v->capacity)
+    {
+        return 0;
+    }
+
+    return vector_reallocation(v, new_capacity);
+}
+
+static void vector_shrink_check(struct vector *v)
+{
+    // A zero threshold never shrinks (`size <= 0 * capacity` would still hold for an emptied vector)
+    if (v->policy.shrink_threshold == 0.0)
+    {
+        return;
+    }
+
+    // Apply the shrink policy as many times as needed, but reallocate only once
+    size_t new_capacity = v->capacity;
+    while (new_capacity > v->policy.min_capacity && v->size <= v->policy.shrink_threshold * new_capacity)
+    {
+        new_capacity = (size_t) (new_capacity / v->policy.growth_factor);
+    }
+    if (new_capacity < v->policy.min_capacity)
+    {
+        new_capacity = v->policy.min_capacity;
+    }
+    if (new_capacity < v->inline_capacity)
+    {
+        new_capacity = v->inline_capacity;
+    }
+
+    // Shrinking is best effort: a failed realloc leaves the old (bigger) block in place
+    if (new_capacity < v->capacity && new_capacity > v->size && new_capacity != 0)
+    {
+        vector_reallocation(v, new_capacity);
+    }
+}
+
 int vector_resize(struct vector *v, size_t new_size)
 {
     // Error check
@@ -65,16 +606,13 @@ int vector_resize(struct vector *v, size_t new_size)
     // Resize only if new_size is greater than current vector capacity
     if (new_size > v->capacity)
     {
-        void *new_data_location = (void *) realloc(v->elems, new_size * v->elem_size);
-        if (new_data_location == NULL)
+        if (vector_reallocation(v, new_size))
         {
             return 1;
         }
-
-        v->elems    = new_data_location;
-        v->capacity = new_size;
     }
     v->size = new_size;
+    DS_STATS_SIZE(v, DS_KIND_VECTOR, v->size);
 
     return 0;
 }
@@ -104,6 +642,7 @@ int vector_get(struct vector const *v, size_t index, void *elem)
     {
         return 1;
     }
+    DS_STATS_SCOPE(v, DS_KIND_VECTOR, DS_OP_GET);
 
     // Get vector `index` element
     memcpy(elem, & ((char *) v->elems)[index * v->elem_size], v->elem_size);
@@ -120,23 +659,22 @@ int vector_push(struct vector *v, void const *elem)
     {
         return 1;
     }
+    DS_STATS_SCOPE(v, DS_KIND_VECTOR, DS_OP_PUSH);
 
     // Check for reallocation
     if (v->size == v->capacity)
     {
-        void *new_data_location = (void *) realloc(v->elems, (2 * v->capacity + 1) * v->elem_size);
-        if (new_data_location == NULL)
+        size_t new_capacity = (size_t) (v->policy.growth_factor * v->capacity) + 1;
+        if (vector_reallocation(v, new_capacity))
         {
             return 1;
         }
-
-        v->elems = new_data_location;
-        v->capacity = 2 * v->capacity + 1;
     }
 
     // Push new element
     memcpy( &( ((char *) v->elems)[v->size * v->elem_size] ), elem, v->elem_size );
     v->size++;
+    DS_STATS_SIZE(v, DS_KIND_VECTOR, v->size);
 
     return 0;
 }
@@ -150,6 +688,7 @@ int vector_pop(struct vector *v, void *elem)
     {
         return 1;
     }
+    DS_STATS_SCOPE(v, DS_KIND_VECTOR, DS_OP_POP);
 
     // Popping
     memcpy(elem, &( ((char *) v->elems)[v->elem_size * --v->size] ), v->elem_size);
@@ -158,54 +697,2447 @@ int vector_pop(struct vector *v, void *elem)
     memset( &( ((char *) v->elems)[v->elem_size * v->size] ), 0x00, v->elem_size);
 
     // Check for reallocation
-    if (2 * v->size <= v->capacity)
-    {
-        vector_resize(v, v->size);
-    }
+    vector_shrink_check(v);
 
     return 0;
 }
 
-size_t vector_size(struct vector const *v)
+int vector_reserve(struct vector *v, size_t new_capacity)
 {
-    return v->size;
-}
+    // Error check
+    assert(v != NULL);
+
+    if (v->elems == NULL)
+    {
+        return 1;
+    }
+
+    // Reserve only if new_capacity is greater than current vector capacity
+    if (new_capacity > v->capacity)
+    {
+        return vector_reallocation(v, new_capacity);
+    }
+
+    return 0;
+}
+
+int vector_push_n(struct vector *v, void const *elems, size_t count)
+{
+    // Error check
+    assert(v != NULL && (elems != NULL || count == 0));
+
+    if (v->elems == NULL)
+    {
+        return 1;
+    }
+
+    // Reserve once for the whole span && copy it in one go
+    if (vector_grow_check(v, v->size + count))
+    {
+        return 1;
+    }
+    if (count != 0)
+    {
+        memcpy( &( ((char *) v->elems)[v->size * v->elem_size] ), elems, count * v->elem_size );
+    }
+    v->size += count;
+    DS_STATS_SIZE(v, DS_KIND_VECTOR, v->size);
+
+    return 0;
+}
+
+int vector_append(struct vector *v, struct vector const *other)
+{
+    // Error check
+    assert(v != NULL && other != NULL);
+
+    if (v->elem_size != other->elem_size)
+    {
+        return 1;
+    }
+
+    // Appending a vector to itself: the span is re-read after a possible reallocation
+    if (v == other)
+    {
+        size_t count = v->size;
+        if (vector_grow_check(v, 2 * count))
+        {
+            return 1;
+        }
+        memcpy( &( ((char *) v->elems)[count * v->elem_size] ), v->elems, count * v->elem_size );
+        v->size += count;
+        DS_STATS_SIZE(v, DS_KIND_VECTOR, v->size);
+
+        return 0;
+    }
+
+    return vector_push_n(v, other->elems, other->size);
+}
+
+int vector_get_range(struct vector const *v, size_t first, size_t count, void *elems)
+{
+    // Error check
+    assert(v != NULL && (elems != NULL || count == 0));
+
+    if (v->elems == NULL || first > v->size || count > v->size - first)
+    {
+        return 1;
+    }
+
+    // Get `count` elements beginning from `first`
+    if (count != 0)
+    {
+        memcpy(elems, &( ((char *) v->elems)[first * v->elem_size] ), count * v->elem_size);
+    }
+
+    return 0;
+}
+
+int vector_insert_range(struct vector *v, size_t index, void const *elems, size_t count)
+{
+    // Error check
+    assert(v != NULL && (elems != NULL || count == 0));
+
+    if (v->elems == NULL || index > v->size)
+    {
+        return 1;
+    }
+
+    // `elems` must not point into the vector itself, since reallocation may move it
+    assert((elems < v->elems || elems >= (void *) &( ((char *) v->elems)[v->capacity * v->elem_size] )) &&
+           "inserting a span of the vector into itself is not supported!");
+
+    if (vector_grow_check(v, v->size + count))
+    {
+        return 1;
+    }
+
+    // Open a gap of `count` elements at `index` && fill it
+    char *gap = &( ((char *) v->elems)[index * v->elem_size] );
+    memmove(gap + count * v->elem_size, gap, (v->size - index) * v->elem_size);
+    DS_STATS_MOVED(v, DS_KIND_VECTOR, (v->size - index) * v->elem_size);
+    if (count != 0)
+    {
+        memcpy(gap, elems, count * v->elem_size);
+    }
+    v->size += count;
+    DS_STATS_SIZE(v, DS_KIND_VECTOR, v->size);
+
+    return 0;
+}
+
+int vector_erase_range(struct vector *v, size_t first, size_t count)
+{
+    // Error check
+    assert(v != NULL);
+
+    if (v->elems == NULL || first > v->size || count > v->size - first)
+    {
+        return 1;
+    }
+
+    // Close the gap && erase freed values (fill with 0's)
+    char *gap = &( ((char *) v->elems)[first * v->elem_size] );
+    memmove(gap, gap + count * v->elem_size, (v->size - first - count) * v->elem_size);
+    DS_STATS_MOVED(v, DS_KIND_VECTOR, (v->size - first - count) * v->elem_size);
+    v->size -= count;
+    memset( &( ((char *) v->elems)[v->size * v->elem_size] ), 0x00, count * v->elem_size);
+
+    // Check for reallocation
+    vector_shrink_check(v);
+
+    return 0;
+}
+
+/**
+ * Zero-copy access: the pointers below point straight into `elems`. They stay valid until the next call that
+ * may reallocate the vector (vector_push, vector_emplace_back, vector_resize, vector_reserve, the bulk
+ * push/insert functions, and vector_pop/vector_erase_range, which may shrink it) or until the vector is deleted.
+ */
+
+void *vector_at(struct vector *v, size_t index)
+{
+    // Error check
+    assert(v != NULL);
+
+    if (v->elems == NULL || index >= v->size)
+    {
+        return NULL;
+    }
+
+    return &( ((char *) v->elems)[index * v->elem_size] );
+}
+
+void *vector_data(struct vector *v)
+{
+    // Error check
+    assert(v != NULL);
+
+    return v->elems;
+}
+
+void *vector_emplace_back(struct vector *v)
+{
+    // Error check
+    assert(v != NULL);
+
+    if (v->elems == NULL)
+    {
+        return NULL;
+    }
+
+    // Check for reallocation
+    if (vector_grow_check(v, v->size + 1))
+    {
+        return NULL;
+    }
+
+    // Hand out the new (uninitialized) last slot to be filled in place
+    ++v->size;
+    DS_STATS_SIZE(v, DS_KIND_VECTOR, v->size);
+
+    return &( ((char *) v->elems)[(v->size - 1) * v->elem_size] );
+}
+
+size_t vector_size(struct vector const *v)
+{
+    return v->size;
+}
+
+size_t vector_realloc_count(struct vector const *v)
+{
+    return v->grow_reallocs + v->shrink_reallocs;
+}
 
 int vector_empty(struct vector const *v)
 {
-    return !v->size;
+    return !v->size;
+}
+
+void vector_print(struct vector const *v, void (*pf)(void const *data))
+{
+    // Error check
+    assert(v != NULL);
+
+    // Printing
+    putchar('[');
+    if (v->size != 0)
+    {
+        int i = 0;
+        while (i < v->size - 1)
+        {
+            pf( &((char *) v->elems)[i * v->elem_size] );
+            printf(", ");
+
+            ++i;
+        }
+        pf( &((char *) v->elems)[i * v->elem_size] );
+    }
+    printf("]\n");
+
+    return;
+}
+
+//----------------------------------------------------SEARCH KERNELS--------------------------------------------------
+
+/**
+ * Linear scans over `elems` for vectors of 32/64-bit integers and floats. Every kernel has a scalar version and,
+ * on x86, AVX2 and SSE4.2 versions; the widest one the CPU supports is picked at run time (checked once).
+ * Floats compare with `==` (so NaN is never found); min/max of a vector that holds NaNs is unspecified.
+ */
+enum VECTOR_ELEM_TYPE
+{
+    VECTOR_INT32,
+    VECTOR_INT64,
+    VECTOR_FLOAT,
+    VECTOR_DOUBLE,
+};
+
+static const size_t VECTOR_NPOS = (size_t) -1;
+
+template <typename T>
+static size_t vector_find_scalar(T const *elems, size_t size, T key)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (elems[i] == key)
+        {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+template <typename T>
+static size_t vector_count_scalar(T const *elems, size_t size, T key)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        count += (elems[i] == key);
+    }
+
+    return count;
+}
+
+template <typename T>
+static void vector_min_max_scalar(T const *elems, size_t size, T *min, T *max)
+{
+    T lo = elems[0], hi = elems[0];
+    for (size_t i = 1; i < size; ++i)
+    {
+        lo = elems[i] < lo ? elems[i] : lo;
+        hi = elems[i] > hi ? elems[i] : hi;
+    }
+
+    *min = lo;
+    *max = hi;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_SIMD_X86 1
+
+enum VECTOR_SIMD_LEVEL
+{
+    VECTOR_SIMD_SCALAR,
+    VECTOR_SIMD_SSE42,
+    VECTOR_SIMD_AVX2,
+};
+
+static enum VECTOR_SIMD_LEVEL vector_simd_level()
+{
+    static const enum VECTOR_SIMD_LEVEL level = __builtin_cpu_supports("avx2")   ? VECTOR_SIMD_AVX2  :
+                                                __builtin_cpu_supports("sse4.2") ? VECTOR_SIMD_SSE42 :
+                                                                                   VECTOR_SIMD_SCALAR;
+    return level;
+}
+
+/**
+ * Per-ISA lane operations: `eq` returns one mask bit per lane. Every operation carries its own target attribute;
+ * the generic kernels below are force-inlined into target-specific wrappers, where the operations inline in turn.
+ */
+#define VECTOR_AVX2  __attribute__((target("avx2"))) static inline
+#define VECTOR_SSE42 __attribute__((target("sse4.2"))) static inline
+
+template <typename T> struct vector_avx2_ops;
+template <typename T> struct vector_sse42_ops;
+
+template <> struct vector_avx2_ops<int32_t>
+{
+    typedef int32_t T;
+    typedef __m256i V;
+    static const size_t LANES = 8;
+
+    VECTOR_AVX2 V set1(T x)             { return _mm256_set1_epi32(x); }
+    VECTOR_AVX2 V load(T const *p)      { return _mm256_loadu_si256((V const *) p); }
+    VECTOR_AVX2 void store(T *p, V a)   { _mm256_storeu_si256((V *) p, a); }
+    VECTOR_AVX2 unsigned eq(V a, V b)   { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+    VECTOR_AVX2 V min(V a, V b)         { return _mm256_min_epi32(a, b); }
+    VECTOR_AVX2 V max(V a, V b)         { return _mm256_max_epi32(a, b); }
+};
+
+template <> struct vector_avx2_ops<int64_t>
+{
+    typedef int64_t T;
+    typedef __m256i V;
+    static const size_t LANES = 4;
+
+    VECTOR_AVX2 V set1(T x)             { return _mm256_set1_epi64x(x); }
+    VECTOR_AVX2 V load(T const *p)      { return _mm256_loadu_si256((V const *) p); }
+    VECTOR_AVX2 void store(T *p, V a)   { _mm256_storeu_si256((V *) p, a); }
+    VECTOR_AVX2 unsigned eq(V a, V b)   { return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b))); }
+    VECTOR_AVX2 V min(V a, V b)         { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+    VECTOR_AVX2 V max(V a, V b)         { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+};
+
+template <> struct vector_avx2_ops<float>
+{
+    typedef float T;
+    typedef __m256 V;
+    static const size_t LANES = 8;
+
+    VECTOR_AVX2 V set1(T x)             { return _mm256_set1_ps(x); }
+    VECTOR_AVX2 V load(T const *p)      { return _mm256_loadu_ps(p); }
+    VECTOR_AVX2 void store(T *p, V a)   { _mm256_storeu_ps(p, a); }
+    VECTOR_AVX2 unsigned eq(V a, V b)   { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+    VECTOR_AVX2 V min(V a, V b)         { return _mm256_min_ps(a, b); }
+    VECTOR_AVX2 V max(V a, V b)         { return _mm256_max_ps(a, b); }
+};
+
+template <> struct vector_avx2_ops<double>
+{
+    typedef double T;
+    typedef __m256d V;
+    static const size_t LANES = 4;
+
+    VECTOR_AVX2 V set1(T x)             { return _mm256_set1_pd(x); }
+    VECTOR_AVX2 V load(T const *p)      { return _mm256_loadu_pd(p); }
+    VECTOR_AVX2 void store(T *p, V a)   { _mm256_storeu_pd(p, a); }
+    VECTOR_AVX2 unsigned eq(V a, V b)   { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+    VECTOR_AVX2 V min(V a, V b)         { return _mm256_min_pd(a, b); }
+    VECTOR_AVX2 V max(V a, V b)         { return _mm256_max_pd(a, b); }
+};
+
+template <> struct vector_sse42_ops<int32_t>
+{
+    typedef int32_t T;
+    typedef __m128i V;
+    static const size_t LANES = 4;
+
+    VECTOR_SSE42 V set1(T x)            { return _mm_set1_epi32(x); }
+    VECTOR_SSE42 V load(T const *p)     { return _mm_loadu_si128((V const *) p); }
+    VECTOR_SSE42 void store(T *p, V a)  { _mm_storeu_si128((V *) p, a); }
+    VECTOR_SSE42 unsigned eq(V a, V b)  { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+    VECTOR_SSE42 V min(V a, V b)        { return _mm_min_epi32(a, b); }
+    VECTOR_SSE42 V max(V a, V b)        { return _mm_max_epi32(a, b); }
+};
+
+template <> struct vector_sse42_ops<int64_t>
+{
+    typedef int64_t T;
+    typedef __m128i V;
+    static const size_t LANES = 2;
+
+    VECTOR_SSE42 V set1(T x)            { return _mm_set1_epi64x(x); }
+    VECTOR_SSE42 V load(T const *p)     { return _mm_loadu_si128((V const *) p); }
+    VECTOR_SSE42 void store(T *p, V a)  { _mm_storeu_si128((V *) p, a); }
+    VECTOR_SSE42 unsigned eq(V a, V b)  { return _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(a, b))); }
+    VECTOR_SSE42 V min(V a, V b)        { return _mm_blendv_epi8(a, b, _mm_cmpgt_epi64(a, b)); }
+    VECTOR_SSE42 V max(V a, V b)        { return _mm_blendv_epi8(b, a, _mm_cmpgt_epi64(a, b)); }
+};
+
+template <> struct vector_sse42_ops<float>
+{
+    typedef float T;
+    typedef __m128 V;
+    static const size_t LANES = 4;
+
+    VECTOR_SSE42 V set1(T x)            { return _mm_set1_ps(x); }
+    VECTOR_SSE42 V load(T const *p)     { return _mm_loadu_ps(p); }
+    VECTOR_SSE42 void store(T *p, V a)  { _mm_storeu_ps(p, a); }
+    VECTOR_SSE42 unsigned eq(V a, V b)  { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+    VECTOR_SSE42 V min(V a, V b)        { return _mm_min_ps(a, b); }
+    VECTOR_SSE42 V max(V a, V b)        { return _mm_max_ps(a, b); }
+};
+
+template <> struct vector_sse42_ops<double>
+{
+    typedef double T;
+    typedef __m128d V;
+    static const size_t LANES = 2;
+
+    VECTOR_SSE42 V set1(T x)            { return _mm_set1_pd(x); }
+    VECTOR_SSE42 V load(T const *p)     { return _mm_loadu_pd(p); }
+    VECTOR_SSE42 void store(T *p, V a)  { _mm_storeu_pd(p, a); }
+    VECTOR_SSE42 unsigned eq(V a, V b)  { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+    VECTOR_SSE42 V min(V a, V b)        { return _mm_min_pd(a, b); }
+    VECTOR_SSE42 V max(V a, V b)        { return _mm_max_pd(a, b); }
+};
+
+// Vector-typed locals of the generic kernels trip -Wpsabi; they never cross a non-inlined call boundary
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template <typename Ops>
+__attribute__((always_inline)) static inline size_t vector_find_simd(typename Ops::T const *elems, size_t size, typename Ops::T key)
+{
+    typename Ops::V keys = Ops::set1(key);
+
+    size_t i = 0;
+    for (; i + Ops::LANES <= size; i += Ops::LANES)
+    {
+        unsigned mask = Ops::eq(Ops::load(&elems[i]), keys);
+        if (mask)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    size_t tail = vector_find_scalar(&elems[i], size - i, key);
+    return i + tail;
+}
+
+template <typename Ops>
+__attribute__((always_inline)) static inline size_t vector_count_simd(typename Ops::T const *elems, size_t size, typename Ops::T key)
+{
+    typename Ops::V keys = Ops::set1(key);
+
+    size_t count = 0, i = 0;
+    for (; i + Ops::LANES <= size; i += Ops::LANES)
+    {
+        count += __builtin_popcount(Ops::eq(Ops::load(&elems[i]), keys));
+    }
+
+    return count + vector_count_scalar(&elems[i], size - i, key);
+}
+
+template <typename Ops>
+__attribute__((always_inline)) static inline void vector_min_max_simd(typename Ops::T const *elems, size_t size,
+                                                                      typename Ops::T *min, typename Ops::T *max)
+{
+    typedef typename Ops::T T;
+
+    if (size < Ops::LANES)
+    {
+        vector_min_max_scalar(elems, size, min, max);
+        return;
+    }
+
+    // Lane-wise min/max over whole blocks, then a scalar pass over the lanes and the tail
+    typename Ops::V lo = Ops::load(elems), hi = lo;
+    size_t i = Ops::LANES;
+    for (; i + Ops::LANES <= size; i += Ops::LANES)
+    {
+        typename Ops::V block = Ops::load(&elems[i]);
+        lo = Ops::min(lo, block);
+        hi = Ops::max(hi, block);
+    }
+
+    T lanes[2 * Ops::LANES];
+    Ops::store(lanes, lo);
+    Ops::store(&lanes[Ops::LANES], hi);
+
+    T lo_s, hi_s, tmp;
+    vector_min_max_scalar(lanes, Ops::LANES, &lo_s, &tmp);
+    vector_min_max_scalar(&lanes[Ops::LANES], Ops::LANES, &tmp, &hi_s);
+    for (; i < size; ++i)
+    {
+        lo_s = elems[i] < lo_s ? elems[i] : lo_s;
+        hi_s = elems[i] > hi_s ? elems[i] : hi_s;
+    }
+
+    *min = lo_s;
+    *max = hi_s;
+}
+
+#pragma GCC diagnostic pop
+
+template <typename T>
+__attribute__((target("avx2"))) static size_t vector_find_avx2(T const *elems, size_t size, T key)
+{
+    return vector_find_simd<vector_avx2_ops<T>>(elems, size, key);
+}
+
+template <typename T>
+__attribute__((target("sse4.2"))) static size_t vector_find_sse42(T const *elems, size_t size, T key)
+{
+    return vector_find_simd<vector_sse42_ops<T>>(elems, size, key);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) static size_t vector_count_avx2(T const *elems, size_t size, T key)
+{
+    return vector_count_simd<vector_avx2_ops<T>>(elems, size, key);
+}
+
+template <typename T>
+__attribute__((target("sse4.2"))) static size_t vector_count_sse42(T const *elems, size_t size, T key)
+{
+    return vector_count_simd<vector_sse42_ops<T>>(elems, size, key);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) static void vector_min_max_avx2(T const *elems, size_t size, T *min, T *max)
+{
+    vector_min_max_simd<vector_avx2_ops<T>>(elems, size, min, max);
+}
+
+template <typename T>
+__attribute__((target("sse4.2"))) static void vector_min_max_sse42(T const *elems, size_t size, T *min, T *max)
+{
+    vector_min_max_simd<vector_sse42_ops<T>>(elems, size, min, max);
+}
+
+#undef VECTOR_AVX2
+#undef VECTOR_SSE42
+#endif
+
+template <typename T>
+static size_t vector_find_kernel(void const *elems, size_t size, void const *key_ptr)
+{
+    T key;
+    memcpy(&key, key_ptr, sizeof(T));
+
+#ifdef VECTOR_SIMD_X86
+    switch (vector_simd_level())
+    {
+        case VECTOR_SIMD_AVX2:  return vector_find_avx2((T const *) elems, size, key);
+        case VECTOR_SIMD_SSE42: return vector_find_sse42((T const *) elems, size, key);
+        default:                break;
+    }
+#endif
+
+    return vector_find_scalar((T const *) elems, size, key);
+}
+
+template <typename T>
+static size_t vector_count_kernel(void const *elems, size_t size, void const *key_ptr)
+{
+    T key;
+    memcpy(&key, key_ptr, sizeof(T));
+
+#ifdef VECTOR_SIMD_X86
+    switch (vector_simd_level())
+    {
+        case VECTOR_SIMD_AVX2:  return vector_count_avx2((T const *) elems, size, key);
+        case VECTOR_SIMD_SSE42: return vector_count_sse42((T const *) elems, size, key);
+        default:                break;
+    }
+#endif
+
+    return vector_count_scalar((T const *) elems, size, key);
+}
+
+template <typename T>
+static void vector_min_max_kernel(void const *elems, size_t size, void *min, void *max)
+{
+    T lo, hi;
+
+#ifdef VECTOR_SIMD_X86
+    switch (vector_simd_level())
+    {
+        case VECTOR_SIMD_AVX2:  vector_min_max_avx2((T const *) elems, size, &lo, &hi);    break;
+        case VECTOR_SIMD_SSE42: vector_min_max_sse42((T const *) elems, size, &lo, &hi);   break;
+        default:                vector_min_max_scalar((T const *) elems, size, &lo, &hi);  break;
+    }
+#else
+    vector_min_max_scalar((T const *) elems, size, &lo, &hi);
+#endif
+
+    memcpy(min, &lo, sizeof(T));
+    memcpy(max, &hi, sizeof(T));
+}
+
+static size_t vector_elem_type_size(enum VECTOR_ELEM_TYPE type)
+{
+    switch (type)
+    {
+        case VECTOR_INT32:  return sizeof(int32_t);
+        case VECTOR_INT64:  return sizeof(int64_t);
+        case VECTOR_FLOAT:  return sizeof(float);
+        case VECTOR_DOUBLE: return sizeof(double);
+        default:            return 0;
+    }
+}
+
+size_t vector_find(struct vector const *v, enum VECTOR_ELEM_TYPE type, void const *key)
+{
+    // Error check
+    assert(v != NULL && key != NULL);
+
+    if (v->elems == NULL || v->elem_size != vector_elem_type_size(type))
+    {
+        return VECTOR_NPOS;
+    }
+
+    // Find index of the first element equal to `key`
+    size_t index = v->size;
+    switch (type)
+    {
+        case VECTOR_INT32:  index = vector_find_kernel<int32_t>(v->elems, v->size, key);   break;
+        case VECTOR_INT64:  index = vector_find_kernel<int64_t>(v->elems, v->size, key);   break;
+        case VECTOR_FLOAT:  index = vector_find_kernel<float>(v->elems, v->size, key);     break;
+        case VECTOR_DOUBLE: index = vector_find_kernel<double>(v->elems, v->size, key);    break;
+    }
+
+    return index == v->size ? VECTOR_NPOS : index;
+}
+
+size_t vector_count(struct vector const *v, enum VECTOR_ELEM_TYPE type, void const *key)
+{
+    // Error check
+    assert(v != NULL && key != NULL);
+
+    if (v->elems == NULL || v->elem_size != vector_elem_type_size(type))
+    {
+        return 0;
+    }
+
+    // Count elements equal to `key`
+    switch (type)
+    {
+        case VECTOR_INT32:  return vector_count_kernel<int32_t>(v->elems, v->size, key);
+        case VECTOR_INT64:  return vector_count_kernel<int64_t>(v->elems, v->size, key);
+        case VECTOR_FLOAT:  return vector_count_kernel<float>(v->elems, v->size, key);
+        case VECTOR_DOUBLE: return vector_count_kernel<double>(v->elems, v->size, key);
+    }
+
+    return 0;
+}
+
+int vector_min_max(struct vector const *v, enum VECTOR_ELEM_TYPE type, void *min, void *max)
+{
+    // Error check
+    assert(v != NULL && min != NULL && max != NULL);
+
+    if (v->elems == NULL || v->size == 0 || v->elem_size != vector_elem_type_size(type))
+    {
+        return 1;
+    }
+
+    // Find the smallest && the greatest element in one pass
+    switch (type)
+    {
+        case VECTOR_INT32:  vector_min_max_kernel<int32_t>(v->elems, v->size, min, max);   break;
+        case VECTOR_INT64:  vector_min_max_kernel<int64_t>(v->elems, v->size, min, max);   break;
+        case VECTOR_FLOAT:  vector_min_max_kernel<float>(v->elems, v->size, min, max);     break;
+        case VECTOR_DOUBLE: vector_min_max_kernel<double>(v->elems, v->size, min, max);    break;
+    }
+
+    return 0;
+}
+
+//-------------------------------------------------PARALLEL ALGORITHMS------------------------------------------------
+
+/**
+ * Bulk algorithms that work directly on `elems` with caller-supplied functions and `elem_size`, as qsort does.
+ * They split the index range into chunks of `grain` elements (VECTOR_DEFAULT_GRAIN if 0) and hand the chunks out
+ * through an atomic counter to the threads of a `struct vector_pool`. The calling thread also takes chunks.
+ * A NULL pool runs everything on the calling thread.
+ * The split into chunks does not depend on the number of threads, so reduce and scan combine in the same order
+ * on any pool: an associative `combine` gives the same result everywhere.
+ */
+
+static const size_t VECTOR_DEFAULT_GRAIN = 1 << 16;
+
+struct vector_pool
+{
+    int threads;                        // workers + the calling thread
+    std::thread *workers;
+
+    std::mutex lock;
+    std::condition_variable wake;       // a new job was posted (or the pool stops)
+    std::condition_variable idle;       // the last worker left the current job
+
+    // Current job: body(ctx, begin, end) for the chunks [begin, begin + grain) of [0, n)
+    void (*body)(void *ctx, size_t begin, size_t end);
+    void *ctx;
+    size_t n;
+    size_t grain;
+    std::atomic<size_t> next;           // first index of the next unclaimed chunk
+
+    size_t generation;                  // number of jobs posted so far
+    int busy;                           // workers still inside the current job
+    int stop;
+};
+
+static void vector_pool_run_chunks(struct vector_pool *pool)
+{
+    for (;;)
+    {
+        size_t begin = pool->next.fetch_add(pool->grain, std::memory_order_relaxed);
+        if (begin >= pool->n)
+        {
+            return;
+        }
+        pool->body(pool->ctx, begin, pool->n - begin < pool->grain ? pool->n : begin + pool->grain);
+    }
+}
+
+static void vector_pool_worker(struct vector_pool *pool)
+{
+    size_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(pool->lock);
+            pool->wake.wait(lock, [pool, seen]() { return pool->stop || pool->generation != seen; });
+            if (pool->stop)
+            {
+                return;
+            }
+            seen = pool->generation;
+        }
+
+        vector_pool_run_chunks(pool);
+
+        std::lock_guard<std::mutex> lock(pool->lock);
+        if (--pool->busy == 0)
+        {
+            pool->idle.notify_one();
+        }
+    }
+}
+
+/**
+ * @brief Pool of `threads` threads including the caller (std::thread::hardware_concurrency() if `threads` <= 0).
+ */
+struct vector_pool *vector_pool_new(int threads)
+{
+    if (threads <= 0)
+    {
+        threads = (int) std::thread::hardware_concurrency();
+        threads = threads > 0 ? threads : 1;
+    }
+
+    // Construction of `vector_pool` structure
+    void *mem = calloc(1, sizeof(struct vector_pool));
+    assert(mem != NULL);
+    struct vector_pool *pool = new (mem) vector_pool();
+
+    pool->threads       = threads;
+    pool->generation    = 0;
+    pool->busy          = 0;
+    pool->stop          = 0;
+    pool->workers       = new std::thread[threads - 1];
+    for (int i = 0; i < threads - 1; ++i)
+    {
+        pool->workers[i] = std::thread(vector_pool_worker, pool);
+    }
+
+    return pool;
+}
+
+struct vector_pool *vector_pool_delete(struct vector_pool *pool)
+{
+    // Error check
+    assert(pool != NULL);
+
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        pool->stop = 1;
+    }
+    pool->wake.notify_all();
+    for (int i = 0; i < pool->threads - 1; ++i)
+    {
+        pool->workers[i].join();
+    }
+
+    // Destruction
+    delete[] pool->workers;
+    pool->~vector_pool();
+    free(pool);
+
+    return NULL;
+}
+
+/**
+ * @brief Run body(ctx, begin, end) over [0, n) in chunks of `grain` elements on every thread of the pool && return
+ *        once all of them are done. Chunks start at multiples of `grain`. One job at a time per pool: `body` must
+ *        not start another parallel algorithm on the same pool.
+ */
+void vector_parallel_for(struct vector_pool *pool, size_t n, size_t grain, void (*body)(void *ctx, size_t begin, size_t end), void *ctx)
+{
+    // Error check
+    assert(body != NULL);
+
+    grain = grain ? grain : VECTOR_DEFAULT_GRAIN;
+
+    // Nothing to share: run the chunks right here
+    if (pool == NULL || pool->threads == 1 || n <= grain)
+    {
+        for (size_t begin = 0; begin < n; begin += grain)
+        {
+            body(ctx, begin, n - begin < grain ? n : begin + grain);
+        }
+        return;
+    }
+
+    // Post the job, take chunks like any worker, then wait for the workers to finish theirs
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        pool->body  = body;
+        pool->ctx   = ctx;
+        pool->n     = n;
+        pool->grain = grain;
+        pool->next.store(0, std::memory_order_relaxed);
+        pool->busy  = pool->threads - 1;
+        ++pool->generation;
+    }
+    pool->wake.notify_all();
+
+    vector_pool_run_chunks(pool);
+
+    std::unique_lock<std::mutex> lock(pool->lock);
+    pool->idle.wait(lock, [pool]() { return pool->busy == 0; });
+}
+
+struct vector_for_each_job
+{
+    char *elems;
+    size_t elem_size;
+    void (*fn)(void *elem, void *ctx);
+    void *ctx;
+};
+
+static void vector_for_each_body(void *arg, size_t begin, size_t end)
+{
+    struct vector_for_each_job *job = (struct vector_for_each_job *) arg;
+    for (size_t i = begin; i < end; ++i)
+    {
+        job->fn(job->elems + i * job->elem_size, job->ctx);
+    }
+}
+
+/**
+ * @brief fn(elem, ctx) for every element, in place.
+ */
+int vector_parallel_for_each(struct vector_pool *pool, struct vector *v, size_t grain, void (*fn)(void *elem, void *ctx), void *ctx)
+{
+    // Error check
+    if (v == NULL || fn == NULL)
+    {
+        return 1;
+    }
+
+    struct vector_for_each_job job = {(char *) v->elems, v->elem_size, fn, ctx};
+    vector_parallel_for(pool, v->size, grain, vector_for_each_body, &job);
+
+    return 0;
+}
+
+struct vector_transform_job
+{
+    char *dst;
+    size_t dst_elem_size;
+    char const *src;
+    size_t src_elem_size;
+    void (*fn)(void *out, void const *in, void *ctx);
+    void *ctx;
+};
+
+static void vector_transform_body(void *arg, size_t begin, size_t end)
+{
+    struct vector_transform_job *job = (struct vector_transform_job *) arg;
+    for (size_t i = begin; i < end; ++i)
+    {
+        job->fn(job->dst + i * job->dst_elem_size, job->src + i * job->src_elem_size, job->ctx);
+    }
+}
+
+/**
+ * @brief fn(out, in, ctx) for every element of `src` into the same index of `dst`, which is resized to the size
+ *        of `src` (its elem_size may differ). `dst` may be `src` for an in-place transform.
+ */
+int vector_parallel_transform(struct vector_pool *pool, struct vector *dst, struct vector const *src, size_t grain,
+                              void (*fn)(void *out, void const *in, void *ctx), void *ctx)
+{
+    // Error check
+    if (dst == NULL || src == NULL || fn == NULL)
+    {
+        return 1;
+    }
+
+    if (dst != src && vector_resize(dst, src->size))
+    {
+        return 1;
+    }
+
+    struct vector_transform_job job = {(char *) dst->elems, dst->elem_size, (char const *) src->elems, src->elem_size, fn, ctx};
+    vector_parallel_for(pool, src->size, grain, vector_transform_body, &job);
+
+    return 0;
+}
+
+struct vector_reduce_job
+{
+    char *elems;
+    size_t elem_size;
+    size_t grain;
+    char *partials;             // one accumulator per chunk (chunk sums for scan, then their prefixes)
+    void const *identity;
+    void (*combine)(void *acc, void const *elem, void *ctx);
+    void *ctx;
+};
+
+static void vector_reduce_body(void *arg, size_t begin, size_t end)
+{
+    struct vector_reduce_job *job = (struct vector_reduce_job *) arg;
+    char *acc = job->partials + begin / job->grain * job->elem_size;
+
+    memcpy(acc, job->identity, job->elem_size);
+    for (size_t i = begin; i < end; ++i)
+    {
+        job->combine(acc, job->elems + i * job->elem_size, job->ctx);
+    }
+}
+
+// Inclusive scan of one chunk, starting from the combined value of all chunks before it
+static void vector_scan_body(void *arg, size_t begin, size_t end)
+{
+    struct vector_reduce_job *job = (struct vector_reduce_job *) arg;
+    char *acc = job->partials + begin / job->grain * job->elem_size;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        char *elem = job->elems + i * job->elem_size;
+        job->combine(acc, elem, job->ctx);
+        memcpy(elem, acc, job->elem_size);
+    }
+}
+
+/**
+ * @brief Fold every element into `result` with combine(acc, elem, ctx), which must be associative (acc = acc op elem)
+ *        && leave `identity` neutral. Accumulators have the elem_size of the vector. Returns 1 on allocation failure.
+ */
+int vector_parallel_reduce(struct vector_pool *pool, struct vector const *v, size_t grain, void const *identity,
+                           void (*combine)(void *acc, void const *elem, void *ctx), void *ctx, void *result)
+{
+    // Error check
+    if (v == NULL || identity == NULL || combine == NULL || result == NULL)
+    {
+        return 1;
+    }
+
+    grain = grain ? grain : VECTOR_DEFAULT_GRAIN;
+    size_t chunks = (v->size + grain - 1) / grain;
+    struct vector_reduce_job job = {(char *) v->elems, v->elem_size, grain, (char *) malloc(chunks ? chunks * v->elem_size : 1), identity, combine, ctx};
+    if (job.partials == NULL)
+    {
+        return 1;
+    }
+
+    // Chunk accumulators in parallel, then fold them in chunk order
+    vector_parallel_for(pool, v->size, grain, vector_reduce_body, &job);
+
+    memcpy(result, identity, v->elem_size);
+    for (size_t c = 0; c < chunks; ++c)
+    {
+        combine(result, job.partials + c * v->elem_size, ctx);
+    }
+    free(job.partials);
+
+    return 0;
+}
+
+/**
+ * @brief Inclusive prefix scan in place: element i becomes elem[0] op ... op elem[i]. Same contract for `combine`
+ *        as vector_parallel_reduce. Two parallel passes (chunk totals, then chunk scans) around a serial scan of
+ *        the chunk totals. Returns 1 on allocation failure.
+ */
+int vector_parallel_scan(struct vector_pool *pool, struct vector *v, size_t grain, void const *identity,
+                         void (*combine)(void *acc, void const *elem, void *ctx), void *ctx)
+{
+    // Error check
+    if (v == NULL || identity == NULL || combine == NULL)
+    {
+        return 1;
+    }
+
+    grain = grain ? grain : VECTOR_DEFAULT_GRAIN;
+    size_t chunks = (v->size + grain - 1) / grain;
+    size_t es = v->elem_size;
+    struct vector_reduce_job job = {(char *) v->elems, es, grain, (char *) malloc((chunks + 1) * es), identity, combine, ctx};
+    if (job.partials == NULL)
+    {
+        return 1;
+    }
+
+    vector_parallel_for(pool, v->size, grain, vector_reduce_body, &job);
+
+    // Chunk totals -> exclusive prefixes (the last slot is scratch)
+    char *carry = job.partials + chunks * es;
+    memcpy(carry, identity, es);
+    for (size_t c = 0; c < chunks; ++c)
+    {
+        char *partial = job.partials + c * es;
+        combine(carry, partial, ctx);
+        memcpy(partial, carry, es);
+    }
+    for (size_t c = chunks; c-- > 1; )
+    {
+        memcpy(job.partials + c * es, job.partials + (c - 1) * es, es);
+    }
+    if (chunks)
+    {
+        memcpy(job.partials, identity, es);
+    }
+
+    vector_parallel_for(pool, v->size, grain, vector_scan_body, &job);
+    free(job.partials);
+
+    return 0;
+}
+
+struct vector_sort_job
+{
+    char *src;
+    char *dst;
+    size_t elem_size;
+    size_t n;
+    size_t width;               // length of the sorted runs that the current round merges pairwise
+    int (*cmp)(void const *, void const *);
+};
+
+static void vector_sort_runs_body(void *arg, size_t begin, size_t end)
+{
+    struct vector_sort_job *job = (struct vector_sort_job *) arg;
+    qsort(job->src + begin * job->elem_size, end - begin, job->elem_size, job->cmp);
+}
+
+// Merge path: how many of the first `k` merged elements come from `a` (ties are taken from `a` first)
+static size_t vector_co_rank(struct vector_sort_job const *job, size_t k, char const *a, size_t m, char const *b, size_t n)
+{
+    size_t lo = k > n ? k - n : 0;
+    size_t hi = k < m ? k : m;
+    while (lo < hi)
+    {
+        size_t i = lo + (hi - lo) / 2;
+        size_t j = k - i;
+        if (j == 0 || i == m || job->cmp(b + (j - 1) * job->elem_size, a + i * job->elem_size) < 0)
+        {
+            hi = i;
+        }
+        else
+        {
+            lo = i + 1;
+        }
+    }
+
+    return lo;
+}
+
+// Output elements [begin, end) of the current round: every pair of runs they touch is merged piecewise
+static void vector_merge_body(void *arg, size_t begin, size_t end)
+{
+    struct vector_sort_job *job = (struct vector_sort_job *) arg;
+    size_t es = job->elem_size;
+
+    while (begin < end)
+    {
+        size_t pair     = begin / (2 * job->width) * (2 * job->width);
+        size_t mid      = pair + job->width < job->n ? pair + job->width : job->n;
+        size_t pair_end = pair + 2 * job->width < job->n ? pair + 2 * job->width : job->n;
+        size_t piece    = end < pair_end ? end : pair_end;
+
+        char const *a = job->src + pair * es;
+        char const *b = job->src + mid * es;
+        size_t m = mid - pair, n = pair_end - mid;
+
+        size_t i = vector_co_rank(job, begin - pair, a, m, b, n), j = begin - pair - i;
+        size_t i_end = vector_co_rank(job, piece - pair, a, m, b, n), j_end = piece - pair - i_end;
+
+        char *out = job->dst + begin * es;
+        while (i < i_end && j < j_end)
+        {
+            if (job->cmp(b + j * es, a + i * es) < 0)
+            {
+                memcpy(out, b + j++ * es, es);
+            }
+            else
+            {
+                memcpy(out, a + i++ * es, es);
+            }
+            out += es;
+        }
+        memcpy(out, a + i * es, (i_end - i) * es);
+        out += (i_end - i) * es;
+        memcpy(out, b + j * es, (j_end - j) * es);
+
+        begin = piece;
+    }
+}
+
+static void vector_copy_body(void *arg, size_t begin, size_t end)
+{
+    struct vector_sort_job *job = (struct vector_sort_job *) arg;
+    memcpy(job->dst + begin * job->elem_size, job->src + begin * job->elem_size, (end - begin) * job->elem_size);
+}
+
+/**
+ * @brief Parallel merge sort with a qsort-style comparator (not stable). Each thread qsorts one run of at least
+ *        `grain` elements, then log2(runs) merge rounds follow. Every round is split into pieces of `grain` output
+ *        elements with merge path, so even the last merge keeps every thread busy. Needs a buffer as big as the
+ *        vector; returns 1 if it can't be allocated.
+ */
+int vector_parallel_sort(struct vector_pool *pool, struct vector *v, size_t grain, int (*cmp)(void const *, void const *))
+{
+    // Error check
+    if (v == NULL || cmp == NULL)
+    {
+        return 1;
+    }
+    if (v->size < 2)
+    {
+        return 0;
+    }
+
+    grain = grain ? grain : VECTOR_DEFAULT_GRAIN;
+    size_t threads = pool ? (size_t) pool->threads : 1;
+    size_t run = (v->size + threads - 1) / threads;
+    run = run > grain ? run : grain;
+
+    char *buffer = (char *) malloc(v->size * v->elem_size);
+    if (buffer == NULL)
+    {
+        return 1;
+    }
+
+    // Sorted runs
+    struct vector_sort_job job = {(char *) v->elems, buffer, v->elem_size, v->size, run, cmp};
+    vector_parallel_for(pool, v->size, run, vector_sort_runs_body, &job);
+
+    // Merge rounds, ping-ponging between the elements && the buffer
+    for (; job.width < job.n; job.width *= 2)
+    {
+        vector_parallel_for(pool, job.n, grain, vector_merge_body, &job);
+        std::swap(job.src, job.dst);
+    }
+    if (job.src != v->elems)
+    {
+        job.dst = (char *) v->elems;
+        vector_parallel_for(pool, job.n, grain, vector_copy_body, &job);
+    }
+    free(buffer);
+
+    return 0;
+}
+
+//-----------------------------------------------------TYPED VECTOR---------------------------------------------------
+
+/**
+ * @brief Typed counterpart of `struct vector`: same layout (elems + size + capacity), the same growth rule
+ *        (2 * capacity + 1) and the same shrink rule as VECTOR_DEFAULT_POLICY (a pop that leaves the vector at
+ *        most a quarter full halves the capacity, never below 16), but the element type is known at compile
+ *        time, so element accesses are plain loads/stores the compiler can inline and vectorize instead of
+ *        `memcpy` calls with a runtime size. push_back/emplace_back may be given an element of the vector itself.
+ *        Functions that may allocate return 0 on success and 1 on allocation failure, like the C interface.
+ */
+template <typename T>
+class Vector
+{
+    static_assert(alignof(T) <= alignof(max_align_t), "Vector<T> storage comes from malloc!");
+
+public:
+    Vector() : elems_(NULL), size_(0), capacity_(0) {}
+
+    explicit Vector(size_t elems) : Vector()
+    {
+        int ret = resize(elems);
+        assert(ret == 0 && "error during Vector<T> allocation!");
+        (void) ret;
+    }
+
+    Vector(Vector const &other) : Vector()
+    {
+        int ret = reserve(other.size_);
+        assert(ret == 0 && "error during Vector<T> allocation!");
+        (void) ret;
+
+        copy_construct(elems_, other.elems_, other.size_);
+        size_ = other.size_;
+    }
+
+    Vector(Vector &&other) noexcept : elems_(other.elems_), size_(other.size_), capacity_(other.capacity_)
+    {
+        other.elems_    = NULL;
+        other.size_     = 0;
+        other.capacity_ = 0;
+    }
+
+    Vector &operator=(Vector other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~Vector()
+    {
+        clear();
+        free(elems_);
+    }
+
+    void swap(Vector &other) noexcept
+    {
+        std::swap(elems_, other.elems_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    size_t size() const         { return size_; }
+    size_t capacity() const     { return capacity_; }
+    bool empty() const          { return size_ == 0; }
+
+    T *data()                   { return elems_; }
+    T const *data() const       { return elems_; }
+    T *begin()                  { return elems_; }
+    T *end()                    { return elems_ + size_; }
+    T const *begin() const      { return elems_; }
+    T const *end() const        { return elems_ + size_; }
+
+    T &operator[](size_t index)             { assert(index < size_); return elems_[index]; }
+    T const &operator[](size_t index) const { assert(index < size_); return elems_[index]; }
+    T &back()                               { assert(size_ > 0); return elems_[size_ - 1]; }
+
+    int reserve(size_t new_capacity)
+    {
+        if (new_capacity <= capacity_)
+        {
+            return 0;
+        }
+
+        return reallocation(new_capacity);
+    }
+
+    int resize(size_t new_size)
+    {
+        if (reserve(new_size))
+        {
+            return 1;
+        }
+
+        // Value-initialize new elements, destroy the cut-off ones
+        for (size_t i = size_; i < new_size; ++i)
+        {
+            new (&elems_[i]) T();
+        }
+        destroy(elems_ + new_size, size_ > new_size ? size_ - new_size : 0);
+        size_ = new_size;
+
+        return 0;
+    }
+
+    template <typename... Args>
+    int emplace_back(Args &&...args)
+    {
+        // Check for reallocation
+        if (size_ == capacity_)
+        {
+            return emplace_back_grow(std::forward<Args>(args)...);
+        }
+
+        // Construct new element in place
+        new (&elems_[size_]) T(std::forward<Args>(args)...);
+        ++size_;
+
+        return 0;
+    }
+
+    int push_back(T const &elem)    { return emplace_back(elem); }
+    int push_back(T &&elem)         { return emplace_back(std::move(elem)); }
+
+    int pop_back(T *elem = NULL)
+    {
+        if (size_ == 0)
+        {
+            return 1;
+        }
+
+        --size_;
+        if (elem != NULL)
+        {
+            *elem = std::move(elems_[size_]);
+        }
+        elems_[size_].~T();
+
+        // Shrink like vector_shrink_check with VECTOR_DEFAULT_POLICY, reallocating only once
+        size_t new_capacity = capacity_;
+        while (new_capacity > VECTOR_DEFAULT_POLICY.min_capacity && size_ <= VECTOR_DEFAULT_POLICY.shrink_threshold * new_capacity)
+        {
+            new_capacity = (size_t) (new_capacity / VECTOR_DEFAULT_POLICY.growth_factor);
+        }
+        if (new_capacity < VECTOR_DEFAULT_POLICY.min_capacity)
+        {
+            new_capacity = VECTOR_DEFAULT_POLICY.min_capacity;
+        }
+
+        // Shrinking is best effort: a failed allocation leaves the old (bigger) block in place
+        if (new_capacity < capacity_ && new_capacity > size_)
+        {
+            reallocation(new_capacity);
+        }
+
+        return 0;
+    }
+
+    void clear()
+    {
+        destroy(elems_, size_);
+        size_ = 0;
+    }
+
+private:
+    T *elems_;
+    size_t size_;
+    size_t capacity_;
+
+    static void destroy(T *first, size_t count)
+    {
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                first[i].~T();
+            }
+        }
+    }
+
+    static void copy_construct(T *dst, T const *src, size_t count)
+    {
+        if (std::is_trivially_copyable<T>::value)
+        {
+            if (count != 0)
+            {
+                memcpy((void *) dst, (void const *) src, count * sizeof(T));
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            new (&dst[i]) T(src[i]);
+        }
+    }
+
+    // Move `count` elements into uninitialized `dst` && destroy them in `src`
+    static void relocate(T *dst, T *src, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            new (&dst[i]) T(std::move_if_noexcept(src[i]));
+            src[i].~T();
+        }
+    }
+
+    /**
+     * @brief Growing push: `args` may refer to an element of this vector, so the new element is built before the
+     *        old block is released (in a temporary for trivially copyable types, in the new block for the others).
+     */
+    template <typename... Args>
+    int emplace_back_grow(Args &&...args)
+    {
+        size_t new_capacity = 2 * capacity_ + 1;
+        if (std::is_trivially_copyable<T>::value)
+        {
+            T elem(std::forward<Args>(args)...);
+            if (reallocation(new_capacity))
+            {
+                return 1;
+            }
+            new (&elems_[size_]) T(std::move(elem));
+            ++size_;
+
+            return 0;
+        }
+
+        T *new_elems = (T *) malloc(new_capacity * sizeof(T));
+        if (new_elems == NULL)
+        {
+            return 1;
+        }
+        new (&new_elems[size_]) T(std::forward<Args>(args)...);
+        relocate(new_elems, elems_, size_);
+        free(elems_);
+
+        elems_      = new_elems;
+        capacity_   = new_capacity;
+        ++size_;
+
+        return 0;
+    }
+
+    int reallocation(size_t new_capacity)
+    {
+        // Trivially copyable elements can be moved by realloc itself
+        if (std::is_trivially_copyable<T>::value)
+        {
+            T *new_elems = (T *) realloc((void *) elems_, new_capacity * sizeof(T));
+            if (new_elems == NULL)
+            {
+                return 1;
+            }
+
+            elems_      = new_elems;
+            capacity_   = new_capacity;
+
+            return 0;
+        }
+
+        // Others are moved (or copied, if the move constructor may throw) into the new block one by one
+        T *new_elems = (T *) malloc(new_capacity * sizeof(T));
+        if (new_elems == NULL)
+        {
+            return 1;
+        }
+
+        relocate(new_elems, elems_, size_);
+        free(elems_);
+
+        elems_      = new_elems;
+        capacity_   = new_capacity;
+
+        return 0;
+    }
+};
+
+//----------------------------------------------------STATIC VECTOR---------------------------------------------------
+
+/**
+ * @brief Fixed-capacity counterpart of Vector<T>: at most N elements stored inline, so there is no heap allocation
+ *        and no reallocation check on the hot path; emplace_back/push_back/resize only fail (return 1) once the
+ *        request does not fit into N. Every member is constexpr, so tables can be built at compile time (see the
+ *        demo). T must be default-constructible, since a C++17 constexpr constructor has to initialize every
+ *        element; popped/cut-off elements are moved out or reset to T(), not destroyed.
+ */
+template <typename T, size_t N>
+class StaticVector
+{
+    static_assert(N > 0, "StaticVector capacity must be greater than zero!");
+
+public:
+    constexpr StaticVector() : elems_{}, size_(0) {}
+
+    static constexpr size_t capacity()  { return N; }
+    constexpr size_t size() const       { return size_; }
+    constexpr bool empty() const        { return size_ == 0; }
+    constexpr bool full() const         { return size_ == N; }
+
+    constexpr T *data()                 { return elems_; }
+    constexpr T const *data() const     { return elems_; }
+    constexpr T *begin()                { return elems_; }
+    constexpr T *end()                  { return elems_ + size_; }
+    constexpr T const *begin() const    { return elems_; }
+    constexpr T const *end() const      { return elems_ + size_; }
+
+    constexpr T &operator[](size_t index)               { assert(index < size_); return elems_[index]; }
+    constexpr T const &operator[](size_t index) const   { assert(index < size_); return elems_[index]; }
+    constexpr T &back()                                 { assert(size_ > 0); return elems_[size_ - 1]; }
+    constexpr T const &back() const                     { assert(size_ > 0); return elems_[size_ - 1]; }
+
+    constexpr int resize(size_t new_size)
+    {
+        if (new_size > N)
+        {
+            return 1;
+        }
+
+        // Value-initialize both the new elements and the cut-off ones
+        for (size_t i = new_size < size_ ? new_size : size_; i < (new_size < size_ ? size_ : new_size); ++i)
+        {
+            elems_[i] = T();
+        }
+        size_ = new_size;
+
+        return 0;
+    }
+
+    constexpr int push_back(T const &elem)
+    {
+        if (size_ == N)
+        {
+            return 1;
+        }
+
+        elems_[size_++] = elem;
+
+        return 0;
+    }
+
+    constexpr int push_back(T &&elem)
+    {
+        if (size_ == N)
+        {
+            return 1;
+        }
+
+        elems_[size_++] = std::move(elem);
+
+        return 0;
+    }
+
+    template <typename... Args>
+    constexpr int emplace_back(Args &&...args)
+    {
+        return push_back(T(std::forward<Args>(args)...));
+    }
+
+    constexpr int pop_back(T *elem = NULL)
+    {
+        if (size_ == 0)
+        {
+            return 1;
+        }
+
+        --size_;
+        if (elem != NULL)
+        {
+            *elem = std::move(elems_[size_]);
+        }
+
+        return 0;
+    }
+
+    constexpr void clear()              { size_ = 0; }
+
+private:
+    T elems_[N];
+    size_t size_;
+};
+
+//---------------------------------------------------SNAPSHOT VECTOR--------------------------------------------------
+
+/**
+ * @brief Copy-on-write vector for read-mostly tables shared between threads. Elements live in fixed-size chunks
+ *        referenced from an immutable version (chunk pointer array + size). Writers (serialized by a mutex) build
+ *        the next version from a draft that shares every chunk with the current one and copies a chunk only on
+ *        its first modification, then publish it with one atomic exchange. Readers pin the current version by
+ *        announcing the global epoch in their own cache line (no lock, no shared counter to bounce) and read it
+ *        for as long as they like; a replaced version is freed by a later commit once every active reader has
+ *        announced a newer epoch (epoch-based reclamation).
+ */
+
+static const size_t COW_CHUNK_BYTES     = 4096;                 // chunks hold the greatest power of two elements that fits
+static const size_t COW_MAX_READERS     = 64;
+static const size_t COW_CACHE_LINE_SIZE = 64;
+static const size_t COW_CHUNK_HEADER    = alignof(max_align_t); // refcount, element bytes stay max-aligned
+
+struct cow_version
+{
+    size_t size;
+    size_t elem_size;
+    size_t chunk_shift;         // a chunk holds 1 << chunk_shift elements
+    size_t chunk_count;
+    size_t chunk_slots;         // capacity of `chunks`
+    char **chunks;              // every chunk: refcount (touched by writers only) + elements
+
+    uint64_t retire_epoch;      // global epoch at the moment the version was replaced
+    struct cow_version *next_retired;
+};
+
+struct cow_reader
+{
+    alignas(COW_CACHE_LINE_SIZE) std::atomic<uint64_t> epoch;   // 0 outside of a read section
+    std::atomic<int> used;
+    struct cow_vector *owner;
+};
+
+struct cow_vector
+{
+    std::atomic<struct cow_version *> current;
+    std::atomic<uint64_t> epoch;        // starts at 1, 0 is the "not reading" mark of reader slots
+
+    std::mutex write_lock;
+    struct cow_version *draft;          // next version, between cow_vector_write_begin and cow_vector_write_commit
+    struct cow_version *retired;        // replaced versions that may still be read
+    size_t chunk_copies;                // chunks copied by writers (all the others were shared)
+
+    struct cow_reader readers[COW_MAX_READERS];
+};
+
+static inline size_t *cow_chunk_refs(char *chunk)
+{
+    return (size_t *) chunk;
+}
+
+static inline char *cow_chunk_elems(char *chunk)
+{
+    return chunk + COW_CHUNK_HEADER;
+}
+
+static char *cow_chunk_new(size_t elem_size, size_t chunk_shift)
+{
+    char *chunk = (char *) malloc(COW_CHUNK_HEADER + (elem_size << chunk_shift));
+    if (chunk != NULL)
+    {
+        *cow_chunk_refs(chunk) = 1;
+    }
+
+    return chunk;
+}
+
+static void cow_chunk_release(char *chunk)
+{
+    if (--*cow_chunk_refs(chunk) == 0)
+    {
+        free(chunk);
+    }
+}
+
+static struct cow_version *cow_version_new(size_t elem_size, size_t chunk_shift, size_t chunk_slots)
+{
+    struct cow_version *ver = (struct cow_version *) calloc(1, sizeof(struct cow_version));
+    if (ver == NULL)
+    {
+        return NULL;
+    }
+
+    ver->chunks = (char **) calloc(chunk_slots ? chunk_slots : 1, sizeof(char *));
+    if (ver->chunks == NULL)
+    {
+        free(ver);
+        return NULL;
+    }
+    ver->elem_size      = elem_size;
+    ver->chunk_shift    = chunk_shift;
+    ver->chunk_slots    = chunk_slots ? chunk_slots : 1;
+
+    return ver;
+}
+
+static void cow_version_delete(struct cow_version *ver)
+{
+    for (size_t c = 0; c < ver->chunk_count; ++c)
+    {
+        cow_chunk_release(ver->chunks[c]);
+    }
+    free(ver->chunks);
+    free(ver);
+}
+
+// Frees the retired versions no reader can see anymore (caller holds `write_lock`)
+static void cow_vector_reclaim(struct cow_vector *cv)
+{
+    uint64_t oldest = UINT64_MAX;
+    for (size_t r = 0; r < COW_MAX_READERS; ++r)
+    {
+        uint64_t announced = cv->readers[r].epoch.load();
+        if (announced != 0 && announced < oldest)
+        {
+            oldest = announced;
+        }
+    }
+
+    // A reader that announced epoch e may hold any version retired at epoch >= e
+    struct cow_version **link = &cv->retired;
+    while (*link != NULL)
+    {
+        struct cow_version *ver = *link;
+        if (ver->retire_epoch < oldest)
+        {
+            *link = ver->next_retired;
+            cow_version_delete(ver);
+        }
+        else
+        {
+            link = &ver->next_retired;
+        }
+    }
+}
+
+struct cow_vector *cow_vector_new(size_t elem_size)
+{
+    // Error check
+    assert(elem_size > 0);
+
+    // Construction (aligned, so that every reader slot sits on its own cache line)
+    void *mem = aligned_alloc(alignof(struct cow_vector), sizeof(struct cow_vector));
+    assert(mem != NULL);
+    struct cow_vector *cv = new (mem) cow_vector();
+
+    size_t chunk_shift = 0;
+    while ((elem_size << (chunk_shift + 1)) <= COW_CHUNK_BYTES)
+    {
+        ++chunk_shift;
+    }
+
+    struct cow_version *empty = cow_version_new(elem_size, chunk_shift, 0);
+    assert(empty != NULL);
+
+    cv->current.store(empty);
+    cv->epoch.store(1);
+    cv->draft           = NULL;
+    cv->retired         = NULL;
+    cv->chunk_copies    = 0;
+    for (size_t r = 0; r < COW_MAX_READERS; ++r)
+    {
+        cv->readers[r].epoch.store(0);
+        cv->readers[r].used.store(0);
+        cv->readers[r].owner = cv;
+    }
+
+    return cv;
+}
+
+struct cow_vector *cow_vector_delete(struct cow_vector *cv)
+{
+    // Error check
+    assert(cv != NULL && cv->draft == NULL);
+
+    // No reader may be inside of a read section anymore
+    cow_version_delete(cv->current.load());
+    while (cv->retired != NULL)
+    {
+        struct cow_version *next = cv->retired->next_retired;
+        cow_version_delete(cv->retired);
+        cv->retired = next;
+    }
+    cv->~cow_vector();
+    free(cv);
+
+    return NULL;
+}
+
+/**
+ * @brief Start the next version: locks out other writers && makes a draft sharing all chunks of the current one.
+ *        The draft is changed with cow_vector_draft_* and becomes visible to readers on cow_vector_write_commit.
+ */
+int cow_vector_write_begin(struct cow_vector *cv)
+{
+    // Error check
+    assert(cv != NULL);
+
+    cv->write_lock.lock();
+    assert(cv->draft == NULL && "cow_vector_write_begin is not reentrant!");
+
+    struct cow_version *cur = cv->current.load(std::memory_order_relaxed);
+    struct cow_version *draft = cow_version_new(cur->elem_size, cur->chunk_shift, cur->chunk_count + 1);
+    if (draft == NULL)
+    {
+        cv->write_lock.unlock();
+        return 1;
+    }
+
+    // Share every chunk
+    draft->size         = cur->size;
+    draft->chunk_count  = cur->chunk_count;
+    for (size_t c = 0; c < cur->chunk_count; ++c)
+    {
+        draft->chunks[c] = cur->chunks[c];
+        ++*cow_chunk_refs(cur->chunks[c]);
+    }
+    cv->draft = draft;
+
+    return 0;
+}
+
+int cow_vector_write_commit(struct cow_vector *cv)
+{
+    // Error check
+    assert(cv != NULL && cv->draft != NULL);
+
+    // Publish the draft, then retire the replaced version under the epoch it was visible in
+    struct cow_version *old = cv->current.exchange(cv->draft);
+    old->retire_epoch = cv->epoch.fetch_add(1);
+    old->next_retired = cv->retired;
+    cv->retired = old;
+    cv->draft   = NULL;
+
+    cow_vector_reclaim(cv);
+    cv->write_lock.unlock();
+
+    return 0;
+}
+
+void cow_vector_write_abort(struct cow_vector *cv)
+{
+    // Error check
+    assert(cv != NULL && cv->draft != NULL);
+
+    cow_version_delete(cv->draft);
+    cv->draft = NULL;
+    cv->write_lock.unlock();
+}
+
+// Chunk `c` of the draft, copied first if some published version shares it
+static char *cow_vector_draft_chunk(struct cow_vector *cv, size_t c)
+{
+    struct cow_version *draft = cv->draft;
+    char *chunk = draft->chunks[c];
+    if (*cow_chunk_refs(chunk) == 1)
+    {
+        return chunk;
+    }
+
+    char *copy = cow_chunk_new(draft->elem_size, draft->chunk_shift);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(cow_chunk_elems(copy), cow_chunk_elems(chunk), draft->elem_size << draft->chunk_shift);
+    cow_chunk_release(chunk);
+    draft->chunks[c] = copy;
+    ++cv->chunk_copies;
+
+    return copy;
+}
+
+int cow_vector_draft_set(struct cow_vector *cv, size_t index, void const *elem)
+{
+    // Error check
+    assert(cv != NULL && cv->draft != NULL && elem != NULL);
+
+    struct cow_version *draft = cv->draft;
+    if (index >= draft->size)
+    {
+        return 1;
+    }
+
+    char *chunk = cow_vector_draft_chunk(cv, index >> draft->chunk_shift);
+    if (chunk == NULL)
+    {
+        return 1;
+    }
+    size_t offset = index & (((size_t) 1 << draft->chunk_shift) - 1);
+    memcpy(cow_chunk_elems(chunk) + offset * draft->elem_size, elem, draft->elem_size);
+
+    return 0;
+}
+
+int cow_vector_draft_push(struct cow_vector *cv, void const *elem)
+{
+    // Error check
+    assert(cv != NULL && cv->draft != NULL && elem != NULL);
+
+    // Every chunk is full: append a private one (growing the pointer array if needed)
+    struct cow_version *draft = cv->draft;
+    if (draft->size == draft->chunk_count << draft->chunk_shift)
+    {
+        if (draft->chunk_count == draft->chunk_slots)
+        {
+            char **chunks = (char **) realloc(draft->chunks, 2 * draft->chunk_slots * sizeof(char *));
+            if (chunks == NULL)
+            {
+                return 1;
+            }
+            draft->chunks       = chunks;
+            draft->chunk_slots  = 2 * draft->chunk_slots;
+        }
+
+        char *chunk = cow_chunk_new(draft->elem_size, draft->chunk_shift);
+        if (chunk == NULL)
+        {
+            return 1;
+        }
+        draft->chunks[draft->chunk_count++] = chunk;
+    }
+
+    ++draft->size;
+    if (cow_vector_draft_set(cv, draft->size - 1, elem))
+    {
+        --draft->size;
+        return 1;
+    }
+
+    return 0;
+}
+
+int cow_vector_draft_pop(struct cow_vector *cv, void *elem)
+{
+    // Error check
+    assert(cv != NULL && cv->draft != NULL);
+
+    struct cow_version *draft = cv->draft;
+    if (draft->size == 0)
+    {
+        return 1;
+    }
+
+    --draft->size;
+    size_t last = draft->size >> draft->chunk_shift;
+    size_t offset = draft->size & (((size_t) 1 << draft->chunk_shift) - 1);
+    if (elem != NULL)
+    {
+        memcpy(elem, cow_chunk_elems(draft->chunks[last]) + offset * draft->elem_size, draft->elem_size);
+    }
+
+    // Drop the last chunk once it is empty
+    if (offset == 0)
+    {
+        cow_chunk_release(draft->chunks[last]);
+        --draft->chunk_count;
+    }
+
+    return 0;
+}
+
+// One-operation transactions
+int cow_vector_set(struct cow_vector *cv, size_t index, void const *elem)
+{
+    if (cow_vector_write_begin(cv))
+    {
+        return 1;
+    }
+    if (cow_vector_draft_set(cv, index, elem))
+    {
+        cow_vector_write_abort(cv);
+        return 1;
+    }
+
+    return cow_vector_write_commit(cv);
+}
+
+int cow_vector_push(struct cow_vector *cv, void const *elem)
+{
+    if (cow_vector_write_begin(cv))
+    {
+        return 1;
+    }
+    if (cow_vector_draft_push(cv, elem))
+    {
+        cow_vector_write_abort(cv);
+        return 1;
+    }
+
+    return cow_vector_write_commit(cv);
+}
+
+int cow_vector_pop(struct cow_vector *cv, void *elem)
+{
+    if (cow_vector_write_begin(cv))
+    {
+        return 1;
+    }
+    if (cow_vector_draft_pop(cv, elem))
+    {
+        cow_vector_write_abort(cv);
+        return 1;
+    }
+
+    return cow_vector_write_commit(cv);
 }
 
-void vector_print(struct vector const *v, void (*pf)(void const *data))
+// Snapshot of a plain vector (e.g. a table loaded at startup)
+struct cow_vector *cow_vector_new_from(struct vector const *v)
 {
     // Error check
     assert(v != NULL);
 
-    // Printing
-    putchar('[');
-    if (v->size != 0)
+    struct cow_vector *cv = cow_vector_new(v->elem_size);
+    int ret = cow_vector_write_begin(cv);
+    for (size_t i = 0; ret == 0 && i < v->size; ++i)
     {
-        int i = 0;
-        while (i < v->size - 1)
-        {
-            pf( &((char *) v->elems)[i * v->elem_size] );
-            printf(", ");
+        ret = cow_vector_draft_push(cv, (char *) v->elems + i * v->elem_size);
+    }
+    assert(ret == 0 && "error during cow_vector allocation!");
+    cow_vector_write_commit(cv);
 
-            ++i;
+    return cv;
+}
+
+/**
+ * @brief Reader slots: every reading thread takes one (at most COW_MAX_READERS at a time) and brackets its reads
+ *        with cow_read_begin/cow_read_end. The version returned by cow_read_begin stays valid until cow_read_end.
+ */
+struct cow_reader *cow_reader_new(struct cow_vector *cv)
+{
+    // Error check
+    assert(cv != NULL);
+
+    for (size_t r = 0; r < COW_MAX_READERS; ++r)
+    {
+        int expected = 0;
+        if (cv->readers[r].used.compare_exchange_strong(expected, 1))
+        {
+            return &cv->readers[r];
         }
-        pf( &((char *) v->elems)[i * v->elem_size] );
     }
-    printf("]\n");
 
-    return;
+    return NULL;
+}
+
+struct cow_reader *cow_reader_delete(struct cow_reader *reader)
+{
+    // Error check
+    assert(reader != NULL && reader->epoch.load() == 0 && "reader is still inside of a read section!");
+
+    reader->used.store(0);
+
+    return NULL;
+}
+
+struct cow_version const *cow_read_begin(struct cow_reader *reader)
+{
+    // Error check
+    assert(reader != NULL && reader->epoch.load(std::memory_order_relaxed) == 0 && "read sections do not nest!");
+
+    // Announce the epoch before loading the version (both seq_cst): a writer that retires the version we are
+    // about to load does it at an epoch >= the announced one, so it is not freed until cow_read_end
+    reader->epoch.store(reader->owner->epoch.load());
+
+    return reader->owner->current.load();
+}
+
+void cow_read_end(struct cow_reader *reader)
+{
+    reader->epoch.store(0, std::memory_order_release);
+}
+
+size_t cow_version_size(struct cow_version const *ver)
+{
+    return ver->size;
+}
+
+void const *cow_version_at(struct cow_version const *ver, size_t index)
+{
+    if (index >= ver->size)
+    {
+        return NULL;
+    }
+
+    size_t offset = index & (((size_t) 1 << ver->chunk_shift) - 1);
+
+    return cow_chunk_elems(ver->chunks[index >> ver->chunk_shift]) + offset * ver->elem_size;
+}
+
+int cow_version_get(struct cow_version const *ver, size_t index, void *elem)
+{
+    void const *src = cow_version_at(ver, index);
+    if (src == NULL || elem == NULL)
+    {
+        return 1;
+    }
+    memcpy(elem, src, ver->elem_size);
+
+    return 0;
+}
+
+//------------------------------------------------------TESTING-------------------------------------------------------
+
+// Define DATA_STRUCTURES_NO_MAIN to include this file into another program (see Benchmark/main.cpp)
+#ifndef DATA_STRUCTURES_NO_MAIN
+
+// Compile-time use of StaticVector: a table of squares baked into the binary
+static constexpr StaticVector<int, 16> make_squares()
+{
+    StaticVector<int, 16> squares;
+    for (int i = 0; !squares.full(); ++i)
+    {
+        squares.push_back(i * i);
+    }
+
+    return squares;
 }
 
+static constexpr StaticVector<int, 16> SQUARES = make_squares();
+static_assert(SQUARES.size() == 16 && SQUARES[5] == 25 && SQUARES.back() == 225, "StaticVector must work in constant expressions!");
 
 static void print_int(void const *data)
 {
    printf("%d", *(int *)data);
 }
 
+// Prevent the compiler from dropping results nobody reads
+static volatile long long vector_bench_sink;
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Push `n` ints and read them back through the C interface and through Vector<int>
+static void vector_benchmark(size_t n)
+{
+    long long c_sum = 0, t_sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    struct vector *v = vector_new(0, sizeof(int));
+    for (size_t i = 0; i < n; ++i)
+    {
+        int elem = (int) i;
+        vector_push(v, &elem);
+    }
+    double c_push = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+    {
+        int elem = 0;
+        vector_get(v, i, &elem);
+        c_sum += elem;
+    }
+    double c_get = elapsed_ns(start);
+    v = vector_delete(v);
+
+    int *span = (int *) malloc(n * sizeof(int));
+    assert(span != NULL);
+    for (size_t i = 0; i < n; ++i)
+    {
+        span[i] = (int) i;
+    }
+
+    start = std::chrono::steady_clock::now();
+    v = vector_new(0, sizeof(int));
+    vector_push_n(v, span, n);
+    double c_push_n = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    vector_get_range(v, 0, n, span);
+    double c_get_range = elapsed_ns(start);
+    v = vector_delete(v);
+    free(span);
+
+    start = std::chrono::steady_clock::now();
+    Vector<int> tv;
+    for (size_t i = 0; i < n; ++i)
+    {
+        tv.push_back((int) i);
+    }
+    double t_push = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+    {
+        t_sum += tv[i];
+    }
+    double t_get = elapsed_ns(start);
+
+    printf("%zu elements (checksums %lld / %lld)\n", n, c_sum, t_sum);
+    printf("    push: struct vector %6.2lf ns/op, Vector<int> %6.2lf ns/op\n", c_push / n, t_push / n);
+    printf("    get:  struct vector %6.2lf ns/op, Vector<int> %6.2lf ns/op\n", c_get / n, t_get / n);
+    printf("    bulk: vector_push_n %6.2lf GB/s, vector_get_range %6.2lf GB/s\n",
+           n * sizeof(int) / c_push_n, n * sizeof(int) / c_get_range);
+}
+
+// Full scans (the key is absent) with the scalar kernel and with the dispatched one
+template <typename T>
+static void vector_search_benchmark(size_t n, enum VECTOR_ELEM_TYPE type, char const *name)
+{
+    struct vector *v = vector_new(n, sizeof(T));
+    for (size_t i = 0; i < n; ++i)
+    {
+        ((T *) v->elems)[i] = (T) (i % 1000);
+    }
+    T key = (T) -1, lo, hi;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t scalar_found = vector_find_scalar((T const *) v->elems, n, key);
+    size_t scalar_count = vector_count_scalar((T const *) v->elems, n, key);
+    vector_min_max_scalar((T const *) v->elems, n, &lo, &hi);
+    double scalar_ns = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t simd_found = vector_find(v, type, &key);
+    size_t simd_count = vector_count(v, type, &key);
+    vector_min_max(v, type, &lo, &hi);
+    double simd_ns = elapsed_ns(start);
+
+    printf("    find + count + min_max (%-6s): scalar %6.3lf ns/elem, dispatched %6.3lf ns/elem%s\n", name,
+           scalar_ns / n, simd_ns / n, (scalar_found != n || simd_found != VECTOR_NPOS || scalar_count || simd_count) ? " (unexpected find)" : "");
+    v = vector_delete(v);
+}
+
+// Read throughput of `threads` readers while a writer keeps updating single elements: a reader-writer lock
+// around every vector_get against snapshot reads (one cow_read_begin/cow_read_end per 64 reads)
+static void cow_vector_benchmark(size_t n, int threads)
+{
+    const size_t READS = 4000000, SECTION = 64;
+
+    struct vector *v = vector_new(n, sizeof(int));
+    for (size_t i = 0; i < n; ++i)
+    {
+        ((int *) v->elems)[i] = (int) i;
+    }
+    struct cow_vector *cv = cow_vector_new_from(v);
+    std::shared_mutex rwlock;
+
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        std::atomic<int> running(threads);
+        std::thread writer([&]() {
+            for (int k = 0; running.load() > 0; ++k)
+            {
+                size_t index = (size_t) k * 7919 % n;
+                if (mode == 0)
+                {
+                    std::unique_lock<std::shared_mutex> lock(rwlock);
+                    vector_set(v, index, &k);
+                }
+                else
+                {
+                    cow_vector_set(cv, index, &k);
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        std::thread readers[64];
+        for (int t = 0; t < threads; ++t)
+        {
+            readers[t] = std::thread([&, t]() {
+                struct cow_reader *reader = mode ? cow_reader_new(cv) : NULL;
+                long long sum = 0;
+                for (size_t i = 0; i < READS; i += SECTION)
+                {
+                    struct cow_version const *ver = mode ? cow_read_begin(reader) : NULL;
+                    for (size_t j = i; j < i + SECTION; ++j)
+                    {
+                        int elem = 0;
+                        size_t index = (j * 31 + t) % n;
+                        if (mode == 0)
+                        {
+                            std::shared_lock<std::shared_mutex> lock(rwlock);
+                            vector_get(v, index, &elem);
+                        }
+                        else
+                        {
+                            elem = *(int const *) cow_version_at(ver, index);
+                        }
+                        sum += elem;
+                    }
+                    if (mode)
+                    {
+                        cow_read_end(reader);
+                    }
+                }
+                if (reader != NULL)
+                {
+                    cow_reader_delete(reader);
+                }
+                running.fetch_sub(1);
+                vector_bench_sink = sum;
+            });
+        }
+        for (int t = 0; t < threads; ++t)
+        {
+            readers[t].join();
+        }
+        double ns = elapsed_ns(start);
+        writer.join();
+
+        printf("    %d reader(s), %s: %8.2lf M reads/s\n", threads, mode ? "snapshot" : "rwlock  ", threads * READS / ns * 1000);
+    }
+    printf("    chunk copies by the writers so far: %zu\n", cv->chunk_copies);
+
+    cv = cow_vector_delete(cv);
+    v = vector_delete(v);
+}
+
+// Startup of a service that needs `n` ints: ingest them into a heap vector against reopening a mapped file
+static void vector_mapped_benchmark(size_t n)
+{
+    char const *path = "vector_bench.bin";
+    remove(path);
+
+    auto start = std::chrono::steady_clock::now();
+    struct vector *v = vector_new(0, sizeof(int));
+    for (size_t i = 0; i < n; ++i)
+    {
+        int elem = (int) i;
+        vector_push(v, &elem);
+    }
+    double ingest = elapsed_ns(start);
+    v = vector_delete(v);
+
+    v = vector_open_mapped(path, sizeof(int));
+    if (v == NULL)
+    {
+        printf("    can't map %s\n", path);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        int elem = (int) i;
+        vector_push(v, &elem);
+    }
+    v = vector_delete(v);
+
+    start = std::chrono::steady_clock::now();
+    v = vector_open_mapped(path, sizeof(int));
+    double reopen = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for (size_t i = 0; i < vector_size(v); ++i)
+    {
+        sum += ((int *) v->elems)[i];
+    }
+    double touch = elapsed_ns(start);
+    vector_bench_sink = sum;
+    v = vector_delete(v);
+    remove(path);
+
+    printf("%zu ints: ingest into a heap vector %8.2lf ms, reopen mapped file %8.3lf ms (+ %8.2lf ms to touch every page)\n",
+           n, ingest / 1e6, reopen / 1e6, touch / 1e6);
+}
+
+// Random reads over `n` ints in malloc'ed storage against huge-page storage (TLB misses dominate the former)
+static void vector_mem_policy_benchmark(size_t n)
+{
+    const size_t READS = 20000000;
+    struct ds_mem_policy const *policies[] = {&DS_MEM_MALLOC_POLICY, &DS_MEM_HUGE_POLICY};
+    char const *names[] = {"malloc", "huge pages"};
+
+    for (int p = 0; p < 2; ++p)
+    {
+        struct vector *v = vector_new(0, sizeof(int));
+        vector_set_mem_policy(v, policies[p]);
+        vector_resize(v, n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            ((int *) v->elems)[i] = (int) i;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        long long sum = 0;
+        uint64_t x = 88172645463325252ULL;
+        for (size_t i = 0; i < READS; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            sum += ((int *) v->elems)[x % n];
+        }
+        double ns = elapsed_ns(start);
+        vector_bench_sink = sum;
+        v = vector_delete(v);
+
+        printf("%zu MiB, random reads (%-10s): %6.2lf ns/read\n", n * sizeof(int) >> 20, names[p], ns / READS);
+    }
+}
+
+static int vector_cmp_uint32(void const *a, void const *b)
+{
+    uint32_t x = *(uint32_t const *) a, y = *(uint32_t const *) b;
+
+    return (x > y) - (x < y);
+}
+
+static void vector_double_uint32(void *out, void const *in, void *ctx)
+{
+    (void) ctx;
+
+    *(uint32_t *) out = 2 * *(uint32_t const *) in;
+}
+
+static void vector_add_uint32(void *acc, void const *elem, void *ctx)
+{
+    (void) ctx;
+
+    *(uint32_t *) acc += *(uint32_t const *) elem;
+}
+
+// Sort, transform, reduce && scan over `n` 32-bit elements on 1 .. 8 threads
+static void vector_parallel_benchmark(size_t n)
+{
+    struct vector *v = vector_new(n, sizeof(uint32_t));
+    struct vector *out = vector_new(n, sizeof(uint32_t));
+    uint32_t zero = 0, sum = 0;
+
+    for (int threads = 1; threads <= 8; threads *= 2)
+    {
+        struct vector_pool *pool = threads > 1 ? vector_pool_new(threads) : NULL;
+
+        uint64_t x = 88172645463325252ULL;
+        for (size_t i = 0; i < n; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            ((uint32_t *) v->elems)[i] = (uint32_t) x;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        vector_parallel_sort(pool, v, 0, vector_cmp_uint32);
+        double sort_ns = elapsed_ns(start);
+
+        start = std::chrono::steady_clock::now();
+        vector_parallel_transform(pool, out, v, 0, vector_double_uint32, NULL);
+        double transform_ns = elapsed_ns(start);
+
+        start = std::chrono::steady_clock::now();
+        vector_parallel_reduce(pool, out, 0, &zero, vector_add_uint32, NULL, &sum);
+        double reduce_ns = elapsed_ns(start);
+
+        start = std::chrono::steady_clock::now();
+        vector_parallel_scan(pool, out, 0, &zero, vector_add_uint32, NULL);
+        double scan_ns = elapsed_ns(start);
+        vector_bench_sink = sum;
+
+        if (pool != NULL)
+        {
+            pool = vector_pool_delete(pool);
+        }
+
+        printf("%zu elements, %d thread(s): sort %8.2lf ms, transform %7.2lf ms, reduce %7.2lf ms, scan %7.2lf ms\n",
+               n, threads, sort_ns / 1e6, transform_ns / 1e6, reduce_ns / 1e6, scan_ns / 1e6);
+    }
+
+    v = vector_delete(v);
+    out = vector_delete(out);
+}
+
 // Should print [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 123]
 //              123
 //              123
@@ -214,9 +3146,45 @@ static void print_int(void const *data)
 //              0
 //              [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 63998, 1144873504, 586, 1144848720, 586, 1869044851, 1546937452, 1147498063, 1702259058]
 //              20
+//              [1, 2, 3] (Vector<std::unique_ptr<int>>: 3 elements, capacity 3)
+//              default policy:      capacity 255, 12 reallocs (10 grow, 2 shrink), capacity 16 when emptied
+//              never shrink policy: capacity 1023, 10 reallocs (10 grow, 0 shrink), capacity 1023 when emptied
+//              [3, 4, 100, 101, 5, 6, 7, 8, 9, 3, 4, 100, 101, 5, 6, 7, 8, 9]
+//              100 101 5 6
+//              43 7 1
+//              find 7: 6, count 3: 1, min/max: 3 101
+//              static: [0, 1, 4, 9], resize past capacity fails: 1
+//              sbo: inline at 16/40/2 elements: 1 0 1, capacity 16, [0, 1]
+//              snapshot: torn reads 0, readers saw version 100 last: 1, one set copied 1 chunk(s)
+//              mapped: reopened with 1000 elements, last 999, capacity 1087
+//              mem policy: 1000000 elements, last 999999, node of elems 0   (-1 outside of Linux)
+//              parallel: sorted 1, sum of doubled 999000, prefix sum at the end 499500
+//
+// Run with `--bench` to compare push/get loops of `struct vector` and Vector<int>, scalar and SIMD scans,
+// reads under a reader-writer lock against snapshot reads, ingest against reopening a mapped file,
+// random reads with base pages against huge pages, and parallel algorithms on 1 .. 8 threads
 
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        vector_benchmark(1000000);
+        vector_benchmark(100000000);
+        vector_search_benchmark<int32_t>(10000000, VECTOR_INT32, "int32");
+        vector_search_benchmark<int64_t>(10000000, VECTOR_INT64, "int64");
+        vector_search_benchmark<float>(10000000, VECTOR_FLOAT, "float");
+        vector_search_benchmark<double>(10000000, VECTOR_DOUBLE, "double");
+        for (int threads = 1; threads <= 8; threads *= 2)
+        {
+            cow_vector_benchmark(100000, threads);
+        }
+        vector_mapped_benchmark(100000000);
+        vector_mem_policy_benchmark((size_t) 1 << 28);
+        vector_parallel_benchmark(100000000);
+
+        return 0;
+    }
+
     struct vector *v = vector_new(10, sizeof(int));
     for (int i = 0; i < 10; i++)
     {
@@ -244,12 +3212,231 @@ int main()
     printf("%d\n", vector_size(v));
 
     v = vector_delete(v);
+
+    // Move-only elements are constructed in place and moved on reallocation
+    Vector<std::unique_ptr<int>> pv;
+    for (int i = 1; i <= 3; ++i)
+    {
+        pv.emplace_back(new int(i));
+    }
+    printf("[%d, %d, %d] (Vector<std::unique_ptr<int>>: %zu elements, capacity %zu)\n", *pv[0], *pv[1], *pv[2], pv.size(), pv.capacity());
+
+    // Grow to 1000 elements, drop to 100, alternate push/pop at that boundary and then empty the vector
+    struct vector_policy const *policies[] = {&VECTOR_DEFAULT_POLICY, &VECTOR_NEVER_SHRINK_POLICY};
+    char const *policy_names[] = {"default policy:     ", "never shrink policy:"};
+    for (int p = 0; p < 2; ++p)
+    {
+        v = vector_new(0, sizeof(int));
+        vector_set_policy(v, policies[p]);
+        for (int i = 0; i < 1000; ++i)
+        {
+            vector_push(v, &i);
+        }
+        while (vector_size(v) > 100)
+        {
+            vector_pop(v, &elem);
+        }
+        for (int i = 0; i < 1000; ++i)
+        {
+            vector_push(v, &i);
+            vector_pop(v, &elem);
+        }
+        printf("%s capacity %zu, %zu reallocs (%zu grow, %zu shrink)", policy_names[p], v->capacity,
+               vector_realloc_count(v), v->grow_reallocs, v->shrink_reallocs);
+        while (vector_pop(v, &elem) == 0)
+        {
+        }
+        printf(", capacity %zu when emptied\n", v->capacity);
+        v = vector_delete(v);
+    }
+
+    // Bulk interface: whole spans are copied with a single memcpy/memmove
+    int span[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int extra[2] = {100, 101};
+    v = vector_new(0, sizeof(int));
+    vector_push_n(v, span, 10);
+    vector_insert_range(v, 5, extra, 2);
+    vector_erase_range(v, 0, 3);
+    vector_append(v, v);
+    vector_print(v, print_int);
+
+    vector_get_range(v, 2, 4, span);
+    printf("%d %d %d %d\n", span[0], span[1], span[2], span[3]);
+
+    // Zero-copy access: write through the pointers into `elems`
+    *(int *) vector_emplace_back(v) = 7;
+    *(int *) vector_at(v, 0) += 40;
+    printf("%d %d %d\n", *(int *) vector_at(v, 0), *(int *) vector_at(v, vector_size(v) - 1), vector_at(v, vector_size(v)) == NULL);
+
+    // Search kernels (SIMD when the CPU supports it)
+    int key = 7, lo = 0, hi = 0;
+    size_t found = vector_find(v, VECTOR_INT32, &key);
+    key = 3;
+    size_t count = vector_count(v, VECTOR_INT32, &key);
+    vector_min_max(v, VECTOR_INT32, &lo, &hi);
+    printf("find 7: %zu, count 3: %zu, min/max: %d %d\n", found, count, lo, hi);
+    v = vector_delete(v);
+
+    // Inline fixed-capacity vector: the table above was filled at compile time
+    StaticVector<int, 16> squares = SQUARES;
+    squares.resize(4);
+    printf("static: [%d, %d, %d, %d], resize past capacity fails: %d\n", squares[0], squares[1], squares[2], squares[3],
+           SQUARES.full() && squares.resize(17) == 1);
+
+    // Small-buffer vector: inline up to 16 elements, on the heap at 40, back inline once a shrink fits into 16
+    v = vector_new_sbo(0, sizeof(int), 16);
+    int where[3] = {0, 0, 0};
+    for (int i = 0; i < 40; ++i)
+    {
+        vector_push(v, &i);
+        where[0] = i == 15 ? vector_elems_inline(v) : where[0];
+    }
+    where[1] = vector_elems_inline(v);
+    while (vector_size(v) > 2)
+    {
+        vector_pop(v, &elem);
+    }
+    where[2] = vector_elems_inline(v);
+    printf("sbo: inline at 16/40/2 elements: %d %d %d, capacity %zu, ", where[0], where[1], where[2], v->capacity);
+    vector_print(v, print_int);
+    v = vector_delete(v);
+
+    // Snapshot vector: the writer rewrites the whole table in every version, readers must never see two versions mixed
+    struct cow_vector *cv = cow_vector_new(sizeof(int));
+    int version = 0;
+    cow_vector_write_begin(cv);
+    for (int i = 0; i < 5000; ++i)
+    {
+        cow_vector_draft_push(cv, &version);
+    }
+    cow_vector_write_commit(cv);
+
+    std::atomic<int> torn(0), saw_last(0);
+    std::thread readers[3];
+    for (int t = 0; t < 3; ++t)
+    {
+        readers[t] = std::thread([cv, &torn, &saw_last]() {
+            struct cow_reader *reader = cow_reader_new(cv);
+            for (int seen = 0; seen < 100; )
+            {
+                struct cow_version const *ver = cow_read_begin(reader);
+                seen = *(int const *) cow_version_at(ver, 0);
+                for (size_t i = 1; i < cow_version_size(ver); ++i)
+                {
+                    torn += *(int const *) cow_version_at(ver, i) != seen;
+                }
+                cow_read_end(reader);
+                std::this_thread::yield();
+            }
+            saw_last += 1;
+            cow_reader_delete(reader);
+        });
+    }
+    for (version = 1; version <= 100; ++version)
+    {
+        cow_vector_write_begin(cv);
+        for (size_t i = 0; i < 5000; ++i)
+        {
+            cow_vector_draft_set(cv, i, &version);
+        }
+        cow_vector_write_commit(cv);
+        std::this_thread::yield();
+    }
+    for (int t = 0; t < 3; ++t)
+    {
+        readers[t].join();
+    }
+
+    size_t copies = cv->chunk_copies;
+    cow_vector_set(cv, 4999, &version);
+    printf("snapshot: torn reads %d, readers saw version 100 last: %d, one set copied %zu chunk(s)\n",
+           torn.load(), saw_last.load() == 3, cv->chunk_copies - copies);
+    cv = cow_vector_delete(cv);
+
+    // File-backed vector: fill, close && map the same file again (size && elements come straight from the file)
+    v = vector_open_mapped("vector_demo.bin", sizeof(int));
+    if (v != NULL)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            vector_push(v, &i);
+        }
+        v = vector_delete(v);
+
+        v = vector_open_mapped("vector_demo.bin", sizeof(int));
+        vector_get(v, 999, &elem);
+        printf("mapped: reopened with %zu elements, last %d, capacity %zu\n", vector_size(v), elem, v->capacity);
+        v = vector_delete(v);
+        remove("vector_demo.bin");
+    }
+
+    // Large-storage policy: blocks of 1 MiB and more are huge-page mappings bound to NUMA node 0 (present everywhere)
+    struct ds_mem_policy large = {(size_t) 1 << 20, DS_HUGE_THP, DS_NUMA_BIND, 1};
+    v = vector_new(0, sizeof(int));
+    vector_set_mem_policy(v, &large);
+    for (int i = 0; i < 1000000; ++i)
+    {
+        vector_push(v, &i);
+    }
+    vector_get(v, 999999, &elem);
+    printf("mem policy: %zu elements, last %d, node of elems %d\n", vector_size(v), elem, ds_mem_node_of(v->elems));
+    v = vector_delete(v);
+
+    // Parallel algorithms on 4 threads in chunks of 64: sort a permutation of 0..999, double it, sum && prefix-sum it
+    struct vector_pool *pool = vector_pool_new(4);
+    v = vector_new(1000, sizeof(uint32_t));
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        ((uint32_t *) v->elems)[i] = i * 7919 % 1000;
+    }
+    vector_parallel_sort(pool, v, 64, vector_cmp_uint32);
+    int sorted = 1;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        sorted = sorted && ((uint32_t *) v->elems)[i] == i;
+    }
+
+    struct vector *doubled = vector_new(0, sizeof(uint32_t));
+    uint32_t zero = 0, sum = 0, prefix = 0;
+    vector_parallel_transform(pool, doubled, v, 64, vector_double_uint32, NULL);
+    vector_parallel_reduce(pool, doubled, 64, &zero, vector_add_uint32, NULL, &sum);
+    vector_parallel_scan(pool, v, 64, &zero, vector_add_uint32, NULL);
+    vector_get(v, 999, &prefix);
+    printf("parallel: sorted %d, sum of doubled %u, prefix sum at the end %u\n", sorted, sum, prefix);
+    doubled = vector_delete(doubled);
+    v = vector_delete(v);
+    pool = vector_pool_delete(pool);
+
+#ifdef DS_STATS
+    ds_stats_dump_text(stdout, "all vectors", ds_stats_global(DS_KIND_VECTOR));
+#endif
 }
 
+#endif // DATA_STRUCTURES_NO_MAIN
+
 /**
  * @brief   vector_push - O(1)
- *          vector_pop - O(1)
+ *          vector_pop - O(1) amortized, shrinking by `growth_factor` only below `shrink_threshold`
+ *                       keeps a constant number of pushes/pops between two reallocations
  *          vector_get - O(1)
  *          vector_set - O(1),
+ *          vector_find / vector_count / vector_min_max - O(n), 4-8 elements per instruction with SSE4.2/AVX2
+ *          vector_at / vector_data - O(1), no copy at all
+ *          vector_emplace_back - O(1) amortized, no copy at all
+ *          vector_push_n / vector_append / vector_get_range - O(k), one reallocation and one memcpy per span of k elements
+ *          vector_insert_range / vector_erase_range - O(n + k), one memmove of the tail per span
+ *          vector_new_sbo - O(1), one allocation for the struct && up to `inline_capacity` elements,
+ *          vector_open_mapped - O(1) for an existing file (no parsing, pages are faulted in on access),
+ *          growth of a mapped vector is ftruncate + mremap, no bytes are copied,
+ *          cow_read_begin / cow_read_end / cow_version_at - O(1), wait-free (one store into the reader's own slot),
+ *          cow_vector_write_begin - O(n / chunk) (the chunk pointer array), cow_vector_draft_set - O(chunk) on the first
+ *          write into a shared chunk, then O(1), cow_vector_write_commit - O(readers + retired versions),
+ *          Vector<T> has the same bounds, with element size fixed at compile time,
+ *          StaticVector<T, N> push_back/pop_back/[] - O(1) with no allocation at all (the elements live inside the object),
+ *          vector_parallel_for_each / transform / reduce - O(n / p + n / grain) on p threads,
+ *          vector_parallel_scan - O(n / p + n / grain) (two parallel passes + a serial pass over the chunk totals),
+ *          vector_parallel_sort - O(n / p * log(n / p)) for the runs + O(n / p * log p) for the merge rounds, O(n) extra memory,
  *          since the number of operations is proportional to the number of bytes that the stack element represents.
  */
+
+#endif // DATA_STRUCTURES_VECTOR_MAIN_CPP